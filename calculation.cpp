@@ -0,0 +1,170 @@
+#include "calculation.h"
+#include "database.h"
+#include "libBrakeCooling/include/trace.h"
+
+BrakeCooling::LandingResult Calculation::landing(const ModelProfile &profile,
+                                                 const BrakeCooling::LandingInputs &inputs,
+                                                 Global::BrakeCategory brake_category)
+{
+    BRAKECOOLING_TRACE_SCOPE("calculation");
+    BRAKECOOLING_TRACE_COUNT(BrakeCooling::Trace::CALCULATIONS);
+    BrakeCooling::LandingResult result;
+    result.reference_be = referenceBrakingEnergy(profile.getReferenceGrid(), inputs.speed, inputs.weight,
+                                                 inputs.temp, inputs.alt, inputs.taxi_distance, &result.in_envelope);
+    result.events = brakingEvents(profile, result.reference_be, brake_category);
+    return result;
+}
+
+BrakeCooling::LandingResult Calculation::cachedLanding(const ModelProfile &profile,
+                                                       const BrakeCooling::LandingInputs &inputs,
+                                                       Global::BrakeCategory brake_category)
+{
+    return resultCache().getOrCompute(profile.getCacheKey(), BrakeCooling::BrakeCategory(brake_category), inputs,
+                                      [&](const BrakeCooling::LandingInputs &quantized_inputs) {
+        return landing(profile, quantized_inputs, brake_category);
+    });
+}
+
+BrakeCooling::ResultCache &Calculation::resultCache()
+{
+    static BrakeCooling::ResultCache cache;
+    return cache;
+}
+
+double Calculation::referenceBrakingEnergy(const BrakeCooling::ReferenceGrid &grid,
+                                           const double &speed,
+                                           const double &weight,
+                                           const double &temp,
+                                           const double &alt,
+                                           const double &taxi_distance,
+                                           bool *ok)
+{
+    BRAKECOOLING_TRACE_SCOPE("stage/reference_brake_energy");
+    BRAKECOOLING_TRACE_NAMED_SCOPE(bracketing, "bracketing");
+    const auto speed_params  = BrakeCooling::Params(speed, grid.getSpeedAxis());
+    const auto weight_params = BrakeCooling::Params(weight / double(1000), grid.getWeightAxis());
+    const auto temp_params   = BrakeCooling::Params(temp, grid.getTempAxis());
+    const auto alt_params    = BrakeCooling::Params(alt / double(1000), grid.getAltAxis());
+    BRAKECOOLING_TRACE_STOP(bracketing);
+
+    if (ok)
+        *ok = !(speed_params.isOutOfEnvelope() || weight_params.isOutOfEnvelope()
+                || temp_params.isOutOfEnvelope() || alt_params.isOutOfEnvelope());
+
+    BRAKECOOLING_TRACE_SCOPE("interpolation");
+    const auto ref_be = BrakeCooling::Interpol(speed_params, weight_params, temp_params, alt_params, grid);
+
+    return ref_be.getReferenceBrakingEnergy() + taxi_distance;
+}
+
+BrakeCooling::EventResults Calculation::brakingEvents(const ModelProfile &profile,
+                                                      const double &reference_braking_energy,
+                                                      Global::BrakeCategory brake_category)
+{
+    BRAKECOOLING_TRACE_SCOPE("stage/braking_events");
+    return BrakeCooling::evaluateEvents(profile.getPerformanceTables(brake_category), reference_braking_energy);
+}
+
+BrakeCooling::InverseResults Calculation::inverse(const ModelProfile &profile,
+                                                 const BrakeCooling::InverseProblem &problem,
+                                                 Global::BrakeCategory brake_category)
+{
+    BRAKECOOLING_TRACE_SCOPE("inverse");
+    if (!profile.hasCompleteTables(brake_category))
+        return {};
+    return BrakeCooling::solveInverse(profile.getPerformanceTables(brake_category), problem);
+}
+
+BrakeCooling::MonteCarloResult Calculation::monteCarlo(const ModelProfile &profile,
+                                                       const BrakeCooling::UncertainInputs &inputs,
+                                                       const BrakeCooling::MonteCarloSettings &settings,
+                                                       Global::BrakeCategory brake_category)
+{
+    if (!profile.hasCompleteTables(brake_category))
+        return {};
+    return BrakeCooling::runMonteCarlo(profile.getPerformanceTables(brake_category), inputs, settings);
+}
+
+Calculation::AdjustedBrakeEnergies Calculation::adjustedBrakeEnergies(const ModelProfile &profile,
+                                                                      const double &reference_braking_energy)
+{
+    BRAKECOOLING_TRACE_SCOPE("stage/adjusted_brake_energy");
+    // the curves of all braking events share the reference brake energy axis
+    const auto bracket = profile.getRefBeAxis().bracket(reference_braking_energy);
+    const auto &curves = profile.getAdjustedBeCurves();
+    AdjustedBrakeEnergies adjusted_be;
+    // above the tables, in the warning band like BrakeCooling::evaluateEvents()
+    if (bracket.status == BrakeCooling::AxisStatus::ClampedHigh) {
+        adjusted_be.fill(std::numeric_limits<double>::infinity());
+        return adjusted_be;
+    }
+    for (std::size_t i = 0; i < adjusted_be.size(); i++)
+        adjusted_be[i] = curves[i].evaluate(bracket);
+    return adjusted_be;
+}
+
+BrakeCooling::EventResults Calculation::coolingTimes(const ModelProfile &profile,
+                                                     const AdjustedBrakeEnergies &adjusted_be,
+                                                     Global::BrakeCategory brake_category)
+{
+    BRAKECOOLING_TRACE_SCOPE("stage/cooling_time");
+    const auto tables = profile.getPerformanceTables(brake_category);
+    BrakeCooling::EventResults results;
+    for (std::size_t i = 0; i < results.size(); i++)
+        results[i] = BrakeCooling::evaluateEvent(tables, adjusted_be[i]);
+    return results;
+}
+
+BrakeCooling::LandingResult IncrementalCalculation::calculate(const std::shared_ptr<const ModelProfile> &profile,
+                                                             const BrakeCooling::LandingInputs &inputs,
+                                                             Global::BrakeCategory brake_category)
+{
+    BRAKECOOLING_TRACE_SCOPE("calculation/incremental");
+    BRAKECOOLING_TRACE_COUNT(BrakeCooling::Trace::CALCULATIONS);
+    // which stages have a changed input of their own. Without a valid previous result, all have.
+    const bool new_profile = !m_valid || profile != m_profile;
+    const bool input_changed[STAGE_COUNT] = {
+        new_profile || inputs.speed != m_inputs.speed || inputs.weight != m_inputs.weight
+                    || inputs.temp != m_inputs.temp || inputs.alt != m_inputs.alt,
+        new_profile || inputs.taxi_distance != m_inputs.taxi_distance,
+        new_profile,
+        new_profile || brake_category != m_brake_category
+    };
+    m_profile = profile;
+    m_inputs = inputs;
+    m_brake_category = brake_category;
+
+    // changed tells whether the previous stage produced a new output
+    bool changed = false;
+    if (input_changed[static_cast<int>(Stage::Interpolation)]) {
+        const double interpolated_be = Calculation::referenceBrakingEnergy(m_profile->getReferenceGrid(), inputs.speed,
+                                                                          inputs.weight, inputs.temp, inputs.alt,
+                                                                          0, &m_in_envelope);
+        changed = new_profile || interpolated_be != m_interpolated_be;
+        m_interpolated_be = interpolated_be;
+        m_compute_counts[static_cast<int>(Stage::Interpolation)]++;
+    }
+    if (changed || input_changed[static_cast<int>(Stage::TaxiDistance)]) {
+        const double reference_be = m_interpolated_be + inputs.taxi_distance;
+        changed = new_profile || reference_be != m_reference_be;
+        m_reference_be = reference_be;
+        m_compute_counts[static_cast<int>(Stage::TaxiDistance)]++;
+    }
+    if (changed || input_changed[static_cast<int>(Stage::AdjustedBrakeEnergy)]) {
+        const auto adjusted_be = Calculation::adjustedBrakeEnergies(*m_profile, m_reference_be);
+        changed = new_profile || adjusted_be != m_adjusted_be;
+        m_adjusted_be = adjusted_be;
+        m_compute_counts[static_cast<int>(Stage::AdjustedBrakeEnergy)]++;
+    }
+    if (changed || input_changed[static_cast<int>(Stage::CoolingTime)]) {
+        m_events = Calculation::coolingTimes(*m_profile, m_adjusted_be, brake_category);
+        m_compute_counts[static_cast<int>(Stage::CoolingTime)]++;
+    }
+    m_valid = true;
+
+    BrakeCooling::LandingResult result;
+    result.reference_be = m_reference_be;
+    result.in_envelope = m_in_envelope;
+    result.events = m_events;
+    return result;
+}
@@ -0,0 +1,146 @@
+#ifndef CALCULATION_H
+#define CALCULATION_H
+
+#include "globals.h"
+#include "libBrakeCooling/include/libBrakeCooling.h"
+#include "libBrakeCooling/include/resultCache.h"
+#include "libBrakeCooling/include/inverseSolver.h"
+#include "libBrakeCooling/include/monteCarlo.h"
+#include "modelprofile.h"
+
+/*!
+ * \brief Runs the brake cooling calculation chain without any user interface
+ * \details Shared by MainWindow and the command line tools. All stages work on the tables held by
+ * the ModelProfile, no database lookups are made, so all methods can be called concurrently from
+ * any thread.
+ */
+class Calculation
+{
+public:
+    /*!
+     * \brief adjusted brake energy of every braking event, in eventIndex() order
+     */
+    using AdjustedBrakeEnergies = std::array<double, 10>;
+
+    /*!
+     * \brief calculates the reference brake energy and all braking events of one landing
+     */
+    static BrakeCooling::LandingResult landing(const ModelProfile &profile,
+                                               const BrakeCooling::LandingInputs &inputs,
+                                               Global::BrakeCategory brake_category);
+
+    /*!
+     * \brief like landing(), but repeated inputs are answered from resultCache(). The calculation
+     * is done with the inputs quantized to the resolution of the cache. Results are keyed on
+     * ModelProfile::getCacheKey(), so they are only reused for the same profile instance.
+     */
+    static BrakeCooling::LandingResult cachedLanding(const ModelProfile &profile,
+                                                     const BrakeCooling::LandingInputs &inputs,
+                                                     Global::BrakeCategory brake_category);
+
+    /*!
+     * \brief the result cache shared by all callers of cachedLanding()
+     */
+    static BrakeCooling::ResultCache &resultCache();
+
+    /*!
+     * \brief interpolates the reference braking energy and adds the taxi distance allowance.
+     * \details weight is given in kg and altitude in ft, as entered in the user interface. If ok is
+     * given, it is set to false when an input is outside of the table and has been clamped.
+     */
+    static double referenceBrakingEnergy(const BrakeCooling::ReferenceGrid &grid,
+                                         const double &speed,
+                                         const double &weight,
+                                         const double &temp,
+                                         const double &alt,
+                                         const double &taxi_distance,
+                                         bool *ok = nullptr);
+
+    /*!
+     * \brief calculates adjusted brake energy, cooling time and cooling band for all braking events
+     * in one pass, see BrakeCooling::evaluateEvents()
+     */
+    static BrakeCooling::EventResults brakingEvents(const ModelProfile &profile,
+                                                    const double &reference_braking_energy,
+                                                    Global::BrakeCategory brake_category);
+
+    /*!
+     * \brief finds the largest weight or speed meeting a target for every braking event
+     * \details see BrakeCooling::solveInverse(). Works on the tables held by the profile, no database
+     * lookups are made.
+     */
+    static BrakeCooling::InverseResults inverse(const ModelProfile &profile,
+                                                const BrakeCooling::InverseProblem &problem,
+                                                Global::BrakeCategory brake_category);
+
+    /*!
+     * \brief samples uncertain inputs and reports the distribution of the outcome of every braking event
+     * \details see BrakeCooling::runMonteCarlo(). Works on the tables held by the profile and uses all
+     * cores, so it should not be called from the GUI thread.
+     */
+    static BrakeCooling::MonteCarloResult monteCarlo(const ModelProfile &profile,
+                                                     const BrakeCooling::UncertainInputs &inputs,
+                                                     const BrakeCooling::MonteCarloSettings &settings,
+                                                     Global::BrakeCategory brake_category);
+
+    /*!
+     * \brief the adjusted brake energy stage of brakingEvents(), for IncrementalCalculation
+     */
+    static AdjustedBrakeEnergies adjustedBrakeEnergies(const ModelProfile &profile,
+                                                       const double &reference_braking_energy);
+
+    /*!
+     * \brief the cooling time and band stage of brakingEvents(), for IncrementalCalculation
+     */
+    static BrakeCooling::EventResults coolingTimes(const ModelProfile &profile,
+                                                   const AdjustedBrakeEnergies &adjusted_be,
+                                                   Global::BrakeCategory brake_category);
+};
+
+/*!
+ * \brief Recalculates a landing stage by stage, reusing the stages whose inputs did not change
+ * \details The calculation is a chain of stages, each one cached with its inputs:
+ * - Interpolation: the reference brake energy from the grid (model, speed, weight, temperature, altitude)
+ * - TaxiDistance: the taxi distance allowance added to it
+ * - AdjustedBrakeEnergy: the adjusted brake energy of every braking event (model, reference brake energy)
+ * - CoolingTime: cooling time and band of every braking event (adjusted brake energies, brake category)
+ *
+ * A stage is recomputed when one of its own inputs changed, or when the stage before it produced a
+ * different output. Changing only the brake category thus repeats the cooling time stage alone.
+ * Not thread safe, use one object per thread.
+ */
+class IncrementalCalculation
+{
+public:
+    enum class Stage {Interpolation = 0, TaxiDistance, AdjustedBrakeEnergy, CoolingTime};
+    static constexpr int STAGE_COUNT = 4;
+
+    BrakeCooling::LandingResult calculate(const std::shared_ptr<const ModelProfile> &profile,
+                                          const BrakeCooling::LandingInputs &inputs,
+                                          Global::BrakeCategory brake_category);
+
+    /*!
+     * \brief drops all cached stage outputs, e.g. after the tables have changed
+     */
+    void invalidate() {m_valid = false;}
+
+    /*!
+     * \brief how often a stage has been computed
+     */
+    int getComputeCount(Stage stage) const {return m_compute_counts[static_cast<int>(stage)];}
+private:
+    bool m_valid = false;
+    std::shared_ptr<const ModelProfile> m_profile;
+    BrakeCooling::LandingInputs m_inputs;
+    Global::BrakeCategory m_brake_category = Global::BrakeCategory::Steel;
+
+    double m_interpolated_be = 0;
+    bool m_in_envelope = true;
+    double m_reference_be = 0;
+    Calculation::AdjustedBrakeEnergies m_adjusted_be = {};
+    BrakeCooling::EventResults m_events;
+
+    int m_compute_counts[STAGE_COUNT] = {};
+};
+
+#endif // CALCULATION_H
@@ -1,7 +1,36 @@
 #include "database.h"
+#include <QDateTime>
+#include <QSet>
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+/*!
+ * \brief the connection and prepared statements of a thread. Worker thread connections are removed
+ * when the thread exits, the main thread keeps the default connection.
+ */
+struct ThreadConnection
+{
+    QString name;
+    QHash<QPair<const char*, QString>, QSqlQuery> queries;
+    ~ThreadConnection()
+    {
+        queries.clear();
+        if (name.isEmpty())
+            return;
+        QSqlDatabase::database(name, false).close();
+        QSqlDatabase::removeDatabase(name);
+    }
+};
+
+thread_local ThreadConnection threadConnection;
+
+} // namespace
 
 double Database::executeQuery(QSqlQuery &query)
 {
+    BRAKECOOLING_TRACE_COUNT("sql/queries");
     if (!query.exec()) {
         error("Unable to execute query.<br>" + query.lastQuery());
         return 0;
@@ -11,31 +40,63 @@ double Database::executeQuery(QSqlQuery &query)
         QString error_msg = "Query result empty.<br>" + query.lastQuery() + "<br>";
         for (const auto &item : query.boundValues())
             error_msg.append(item.toString() + "<br>");
+        query.finish();
         error(error_msg);
         return 0;
     }
 
     //DEB << "DB Return: " << query.value(0).toDouble();
-    return query.value(0).toDouble();
+    const double value = query.value(0).toDouble();
+    query.finish(); // reset the statement so it can be executed again
+    return value;
+}
+
+QSqlQuery &Database::preparedQuery(const char *query, const QString &table_name)
+{
+    auto &queries = threadConnection.queries;
+    const auto key = qMakePair(query, table_name);
+    auto it = queries.find(key);
+    if (it == queries.end()) {
+        QSqlQuery prepared(database());
+        prepared.setForwardOnly(true);
+        if (!prepared.prepare(QString(query).arg(table_name)))
+            error("Unable to prepare query.<br>" + QString(query).arg(table_name));
+        it = queries.insert(key, prepared);
+    }
+    return it.value();
+}
+
+void Database::clearPreparedQueries()
+{
+    threadConnection.queries.clear();
 }
 
 void Database::error(const QString& error_msg, QWidget *parent)
 {
-    QMessageBox mb(parent);
-    mb.setText("<b>Database Error</b><br><br>" + error_msg);
-    mb.setIcon(QMessageBox::Warning);
-    mb.exec();
+    if (errorHandler)
+        errorHandler(error_msg, parent);
+    else
+        qWarning().noquote() << "Database Error:" << QString(error_msg).replace(QLatin1String("<br>"), QLatin1String("\n"));
 }
 
-bool Database::connect(QWidget *parent)
+bool Database::connect(QWidget *parent, const QString &db_file)
 {
     if (!QSqlDatabase::isDriverAvailable(DRIVER)) {
         error("No SQLITE Driver availabe.", parent);
         return false;
     }
 
+    // statements of an earlier connection become invalid, and the ones of the main thread have to be
+    // gone before the driver is unloaded
+    clearPreparedQueries();
+    static bool clear_routine_added = false;
+    if (!clear_routine_added) {
+        qAddPostRoutine(clearPreparedQueries);
+        clear_routine_added = true;
+    }
+
     QSqlDatabase db = QSqlDatabase::addDatabase(DRIVER);
-    db.setDatabaseName(DB_FILE);
+    db.setDatabaseName(db_file);
 
     if (!db.open()) {
         error(QString("Unable to establish database connection. The following error has ocurred:<br><br>%1")
@@ -43,7 +104,7 @@ bool Database::connect(QWidget *parent)
         return false;
     }
 
-    QSqlQuery q;
+    QSqlQuery q(db);
     q.prepare(CHECK_QUERY);
     q.exec();
     if (!q.next()) {
@@ -51,10 +112,100 @@ bool Database::connect(QWidget *parent)
         return false;
     }
 
+    dbFile = db_file;
+    mainThread = QThread::currentThread();
+
+    // fails for read only files, which cannot be written to concurrently anyway
+    if (q.exec(QStringLiteral("PRAGMA journal_mode=WAL")) && q.next())
+        DEB << "Journal mode:" << q.value(0).toString();
+
+    migrate();
+
     DEB << "Database connection established.";
     return true;
 }
 
+void Database::disconnect()
+{
+    clearPreparedQueries();
+    QSqlDatabase::database(QLatin1String(QSqlDatabase::defaultConnection), false).close();
+    QSqlDatabase::removeDatabase(QLatin1String(QSqlDatabase::defaultConnection));
+    dbFile.clear();
+    mainThread = nullptr;
+}
+
+void Database::migrate()
+{
+    BRAKECOOLING_TRACE_SCOPE("sql/migrate");
+    QSqlDatabase db = database();
+    QSqlQuery query(db);
+    QSet<QString> indexes;
+    if (query.exec(QStringLiteral("SELECT name FROM sqlite_master WHERE type = 'index'")))
+        while (query.next())
+            indexes.insert(query.value(0).toString());
+
+    // queried here rather than with getModelNames(), a file without models is not an error yet
+    QStringList models;
+    if (query.exec(QStringLiteral("SELECT name FROM MODELS")))
+        while (query.next())
+            models.append(query.value(0).toString());
+
+    for (const QString &model : models) {
+        const QString table_name = QString(model).replace(QLatin1Char('-'), QLatin1Char('_'));
+        QStringList statements;
+        for (const auto &index : LOOKUP_INDEXES)
+            if (!indexes.contains(QString(index.name).arg(table_name)))
+                statements.append(QString(index.statement).arg(table_name));
+        if (statements.isEmpty())
+            continue;
+
+        db.transaction();
+        bool ok = true;
+        for (const QString &statement : statements)
+            ok = ok && query.exec(statement);
+        if (ok && db.commit()) {
+            DEB << "Added" << statements.size() << "lookup indexes to the tables of" << model;
+        } else {
+            DEB << "Unable to add the lookup indexes of" << model << ':' << query.lastError().text();
+            db.rollback();
+        }
+    }
+}
+
+QSqlDatabase Database::database()
+{
+    if (QThread::currentThread() == mainThread)
+        return QSqlDatabase::database();
+
+    auto &connection = threadConnection;
+    if (connection.name.isEmpty()) {
+        static std::atomic<int> connection_count{0};
+        connection.name = QStringLiteral("Database_%1").arg(connection_count++);
+        QSqlDatabase db = QSqlDatabase::addDatabase(DRIVER, connection.name);
+        db.setDatabaseName(dbFile);
+        db.setConnectOptions(THREAD_CONNECTION_OPTIONS);
+        if (!db.open())
+            error(QString("Unable to open a database connection for a worker thread. The following error has ocurred:<br><br>%1")
+                  .arg(db.lastError().databaseText()));
+        DEB << "Opened" << connection.name << "for thread" << QThread::currentThread();
+    }
+    return QSqlDatabase::database(connection.name, false);
+}
+
+QStringList Database::getModelNames()
+{
+    QSqlQuery query(database());
+    query.setForwardOnly(true);
+    if (!query.exec(QStringLiteral("SELECT name FROM MODELS ORDER BY row_id"))) {
+        error("Unable to execute query.<br>" + query.lastQuery());
+        return {};
+    }
+    QStringList names;
+    while (query.next())
+        names.append(query.value(0).toString());
+    return names;
+}
+
 std::vector<double> Database::getTableValues(const QString &table_name, Global::Parameter parameter)
 {
     QString par;
@@ -82,9 +233,9 @@ std::vector<double> Database::getTableValues(const QString &table_name, Global::
         break;
     }
 
-    auto q = QString("SELECT COUNT(%1) FROM B_737_800WSFP1_KEYS WHERE %2 NOT NULL").arg(par, par);
+    auto q = QString("SELECT COUNT(%1) FROM %2_KEYS WHERE %3 NOT NULL").arg(par, table_name, par);
 
-    QSqlQuery query;
+    QSqlQuery query(database());
     query.prepare(q);
     query.exec();
 
@@ -115,6 +266,244 @@ std::vector<double> Database::getTableValues(const QString &table_name, Global::
     return ret;
 }
 
+BrakeCooling::ReferenceGrid Database::getReferenceGrid(const QString &table_name)
+{
+    BRAKECOOLING_TRACE_SCOPE("sql/reference_grid");
+    BrakeCooling::ReferenceGrid grid(getTableValues(table_name, Global::Parameter::Speed),
+                                     getTableValues(table_name, Global::Parameter::Weight),
+                                     getTableValues(table_name, Global::Parameter::Temperature),
+                                     getTableValues(table_name, Global::Parameter::Altitude));
+
+    QSqlQuery query(database());
+    query.setForwardOnly(true);
+    query.prepare(QString("SELECT speed, weight, temperature, altitude, referenceBE FROM %1_RAW_BE").arg(table_name));
+    if (!query.exec()) {
+        error("Unable to execute query.<br>" + query.lastQuery());
+        return grid;
+    }
+
+    int off_grid = 0;
+    while (query.next())
+        if (!grid.setValue(query.value(0).toDouble(), query.value(1).toDouble(), query.value(2).toDouble(),
+                           query.value(3).toDouble(), query.value(4).toDouble()))
+            off_grid++;
+
+    if (off_grid > 0)
+        DEB << "Ignored" << off_grid << "rows of" << table_name + "_RAW_BE not matching the key axes.";
+    if (!grid.isComplete())
+        DEB << "Reference grid for" << table_name << "is incomplete.";
+    return grid;
+}
+
+BrakeCooling::TableData Database::getTableData(const QString &table_name)
+{
+    BrakeCooling::TableData data;
+    const auto grid = getReferenceGrid(table_name);
+    data.speeds  = grid.getSpeeds();
+    data.weights = grid.getWeights();
+    data.temps   = grid.getTemps();
+    data.alts    = grid.getAlts();
+    data.reference_be.assign(grid.getValues(), grid.getValues() + grid.getValueCount());
+    data.ref_bes         = getTableValues(table_name, Global::Parameter::RefBe);
+    data.adjusted_steel  = getTableValues(table_name, Global::Parameter::AdjustedSteel);
+    data.adjusted_carbon = getTableValues(table_name, Global::Parameter::AdjustedCarbon);
+
+    data.adjusted_be = getAdjustedBeTable(table_name, BrakeCooling::GridAxis(data.ref_bes));
+    data.cooling_time = getCoolingTimeTable(table_name, Global::BrakeCategory::Steel, BrakeCooling::GridAxis(data.adjusted_steel));
+    const auto carbon = getCoolingTimeTable(table_name, Global::BrakeCategory::Carbon, BrakeCooling::GridAxis(data.adjusted_carbon));
+    data.cooling_time.insert(data.cooling_time.end(), carbon.begin(), carbon.end());
+    return data;
+}
+
+std::vector<double> Database::getAdjustedBeTable(const QString &table_name, const BrakeCooling::GridAxis &ref_be_axis)
+{
+    BRAKECOOLING_TRACE_SCOPE("sql/adjusted_be_table");
+    std::vector<double> table(10 * ref_be_axis.size(), std::numeric_limits<double>::quiet_NaN());
+    QSqlQuery query(database());
+    query.setForwardOnly(true);
+    query.prepare(QString("SELECT refBE, event, revT, adjustedBE FROM %1_ADJ_BE").arg(table_name));
+    if (!query.exec()) {
+        error("Unable to execute query.<br>" + query.lastQuery());
+        return table;
+    }
+    while (query.next()) {
+        const auto index = ref_be_axis.indexOf(query.value(0).toDouble());
+        const int event = query.value(1).toInt();
+        if (index == ref_be_axis.size() || event < 0 || event > 4)
+            continue;
+        const auto row = BrakeCooling::eventIndex(static_cast<BrakeCooling::BrakingEvent>(event), query.value(2).toBool());
+        table[row * ref_be_axis.size() + index] = query.value(3).toDouble();
+    }
+    return table;
+}
+
+std::vector<double> Database::getCoolingTimeTable(const QString &table_name, Global::BrakeCategory brake_category,
+                                                  const BrakeCooling::GridAxis &adjusted_axis)
+{
+    BRAKECOOLING_TRACE_SCOPE("sql/cooling_time_table");
+    std::vector<double> table(adjusted_axis.size(), std::numeric_limits<double>::quiet_NaN());
+    QSqlQuery query(database());
+    query.setForwardOnly(true);
+    query.prepare(QString("SELECT adjustedBE, coolingTime FROM %1_COOLING_TIME WHERE brakeCategory = ?").arg(table_name));
+    query.addBindValue(static_cast<int>(brake_category));
+    if (!query.exec()) {
+        error("Unable to execute query.<br>" + query.lastQuery());
+        return table;
+    }
+    while (query.next()) {
+        const auto index = adjusted_axis.indexOf(query.value(0).toDouble());
+        if (index < adjusted_axis.size())
+            table[index] = query.value(1).toDouble();
+    }
+    return table;
+}
+
+bool Database::importModel(const QString &model, const QString &table_name, const BrakeCooling::TableData &data,
+                           QString *error)
+{
+    BRAKECOOLING_TRACE_SCOPE("sql/import");
+    const auto fail = [error](const QString &error_msg) {
+        if (error)
+            *error = error_msg;
+        return false;
+    };
+    std::string consistency_error;
+    if (!data.isConsistent(&consistency_error))
+        return fail(QString::fromStdString(consistency_error));
+    if (const std::size_t missing = data.missingValues(); missing > 0)
+        return fail(QString("The tables are incomplete, %1 values are missing.").arg(missing));
+
+    // statements of this thread may refer to the tables about to be replaced
+    clearPreparedQueries();
+    QSqlDatabase db = database();
+    if (!db.transaction())
+        return fail(db.lastError().text());
+    QSqlQuery query(db);
+    const auto rollback = [&]() {
+        const QString error_msg = query.lastError().text() + ": " + query.lastQuery();
+        db.rollback();
+        return fail(error_msg);
+    };
+
+    for (const char *table : MODEL_TABLES)
+        if (!query.exec(QString("DROP TABLE IF EXISTS \"%1\"").arg(QString(table).arg(table_name))))
+            return rollback();
+    for (const char *statement : MODEL_SCHEMA)
+        if (!query.exec(QString(statement).arg(table_name)))
+            return rollback();
+
+    const std::size_t speeds = data.speeds.size();
+    const std::size_t weights = data.weights.size();
+    const std::size_t temps = data.temps.size();
+    query.prepare(QString("INSERT INTO %1_RAW_BE (weight, temperature, speed, altitude, referenceBE) "
+                          "VALUES (?, ?, ?, ?, ?)").arg(table_name));
+    for (std::size_t i = 0; i < data.reference_be.size(); i++) {
+        query.addBindValue(data.weights[i / speeds % weights]);
+        query.addBindValue(data.temps[i / (speeds * weights) % temps]);
+        query.addBindValue(data.speeds[i % speeds]);
+        query.addBindValue(data.alts[i / (speeds * weights * temps)]);
+        query.addBindValue(data.reference_be[i]);
+        if (!query.exec())
+            return rollback();
+    }
+
+    query.prepare(QString("INSERT INTO %1_ADJ_BE (refBE, event, revT, adjustedBE) VALUES (?, ?, ?, ?)").arg(table_name));
+    for (std::size_t row = 0; row < 10; row++) {
+        for (std::size_t i = 0; i < data.ref_bes.size(); i++) {
+            query.addBindValue(data.ref_bes[i]);
+            query.addBindValue(int(row % 5));
+            query.addBindValue(int(row / 5));
+            query.addBindValue(data.adjusted_be[row * data.ref_bes.size() + i]);
+            if (!query.exec())
+                return rollback();
+        }
+    }
+
+    query.prepare(QString("INSERT INTO %1_COOLING_TIME (brakeCategory, adjustedBE, coolingTime) VALUES (?, ?, ?)").arg(table_name));
+    for (std::size_t i = 0; i < data.cooling_time.size(); i++) {
+        const bool carbon = i >= data.adjusted_steel.size();
+        query.addBindValue(int(carbon));
+        query.addBindValue(carbon ? data.adjusted_carbon[i - data.adjusted_steel.size()] : data.adjusted_steel[i]);
+        query.addBindValue(data.cooling_time[i]);
+        if (!query.exec())
+            return rollback();
+    }
+
+    // the key columns have different lengths, shorter columns are padded with NULL
+    const std::vector<double>* keys[] = {&data.speeds, &data.weights, &data.temps, &data.alts, &data.ref_bes,
+                                         &data.adjusted_steel, &data.adjusted_carbon};
+    std::size_t rows = 0;
+    for (const auto *key : keys)
+        rows = std::max(rows, key->size());
+    query.prepare(QString("INSERT INTO %1_KEYS (speed, weight, temp, alt, referenceBrakeEnergy, "
+                          "adjustedBrakeEnergySteel, adjustedBrakeEnergyCarbon) VALUES (?, ?, ?, ?, ?, ?, ?)").arg(table_name));
+    for (std::size_t row = 0; row < rows; row++) {
+        for (const auto *key : keys)
+            query.addBindValue(row < key->size() ? QVariant(key->at(row)) : QVariant());
+        if (!query.exec())
+            return rollback();
+    }
+
+    for (const auto &index : LOOKUP_INDEXES)
+        if (!query.exec(QString(index.statement).arg(table_name)))
+            return rollback();
+
+    query.prepare(QStringLiteral("INSERT INTO MODELS (name) SELECT ? WHERE NOT EXISTS (SELECT 1 FROM MODELS WHERE name = ?)"));
+    query.addBindValue(model);
+    query.addBindValue(model);
+    if (!query.exec())
+        return rollback();
+    query.finish();
+
+    // the transaction is visible to this connection, so the model is checked as it will be loaded
+    const BrakeCooling::TableData loaded = getTableData(table_name);
+    if (loaded.speeds != data.speeds || loaded.weights != data.weights || loaded.temps != data.temps
+            || loaded.alts != data.alts || loaded.ref_bes != data.ref_bes || loaded.adjusted_steel != data.adjusted_steel
+            || loaded.adjusted_carbon != data.adjusted_carbon || loaded.reference_be != data.reference_be
+            || loaded.adjusted_be != data.adjusted_be || loaded.cooling_time != data.cooling_time) {
+        db.rollback();
+        return fail("The tables read back do not match the imported data.");
+    }
+
+    if (!db.commit()) {
+        const QString error_msg = db.lastError().text();
+        db.rollback();
+        return fail(error_msg);
+    }
+    return true;
+}
+
+QString Database::tableFileName(const QString &table_name)
+{
+    const QFileInfo db_file(dbFile);
+    return db_file.dir().filePath(table_name + QLatin1String(".bct"));
+}
+
+std::shared_ptr<const BrakeCooling::TableFile> Database::openTableFile(const QString &table_name)
+{
+    const QFileInfo table_file(tableFileName(table_name));
+    if (!table_file.exists())
+        return nullptr;
+
+    // in WAL mode, commits only reach the database file itself at the next checkpoint. SQLite removes
+    // the log when the last connection closes and the next connection creates it again, empty, so
+    // only a log holding frames tells of changes.
+    const QFileInfo db_file(dbFile);
+    const QFileInfo wal_file(dbFile + QLatin1String("-wal"));
+    const QDateTime db_modified = wal_file.size() > 0 ? std::max(db_file.lastModified(), wal_file.lastModified())
+                                                      : db_file.lastModified();
+    if (db_modified > table_file.lastModified()) {
+        DEB << table_file.fileName() << "is older than the database, loading tables from the database.";
+        return nullptr;
+    }
+
+    std::string error_msg;
+    auto file = BrakeCooling::TableFile::open(QFile::encodeName(table_file.filePath()).toStdString(), &error_msg);
+    if (!file)
+        DEB << "Unable to use compiled tables:" << QString::fromStdString(error_msg);
+    return file;
+}
+
 std::array<double, 16> Database::getReferenceBrakingEnergyValues(
         const QString &table_name,
         const BrakeCooling::Params &speed,
@@ -137,15 +526,16 @@ std::array<double, 16> Database::getReferenceBrakingEnergyValues(
         i & (1 << 2) ? temp_temp   = temp_high   : temp_temp   = temp_low;      // 3rd LSB set, temperature high
         i & (1 << 3) ? alt_temp    = alt_high    : alt_temp    = alt_low;       // 4th LSB set, altitude high
 
-        DEB << "Retreiving data for: " << speed_temp << weight_temp << temp_temp << alt_temp << " index : " << i;
-        DEB << "Result: " << getRefBe(table_name, speed_temp, weight_temp, temp_temp, alt_temp);
         raw_braking_energy[i] = getRefBe(table_name, speed_temp, weight_temp, temp_temp, alt_temp);
+        DEB << "Retreived data for: " << speed_temp << weight_temp << temp_temp << alt_temp << " index : " << i
+            << "Result: " << raw_braking_energy[i];
     }
     return raw_braking_energy;
 }
 
 double Database::getCautionValue(const QString &table_name, Global::BrakeCategory brake_category)
 {
+    BRAKECOOLING_TRACE_SCOPE("sql/caution_value");
     QString value;
     switch (brake_category) {
     case Global::BrakeCategory::Steel:
@@ -159,7 +549,7 @@ double Database::getCautionValue(const QString &table_name, Global::BrakeCategor
                      "WHERE %3 < "
                      "(SELECT MAX(%4) FROM %5_KEYS ) ")
             .arg(value, table_name, value, value, table_name);
-    QSqlQuery query;
+    QSqlQuery query(database());
     query.prepare(q);
     query.exec();
 
@@ -173,6 +563,7 @@ double Database::getCautionValue(const QString &table_name, Global::BrakeCategor
 
 double Database::getWarningValue(const QString &table_name, Global::BrakeCategory brake_category)
 {
+    BRAKECOOLING_TRACE_SCOPE("sql/warning_value");
     QString value;
     switch (brake_category) {
     case Global::BrakeCategory::Steel:
@@ -183,7 +574,7 @@ double Database::getWarningValue(const QString &table_name, Global::BrakeCategor
         break;
     }
     auto q = QString("SELECT MAX(%1) FROM %2_KEYS").arg(value, table_name);
-    QSqlQuery query;
+    QSqlQuery query(database());
     query.prepare(q);
     query.exec();
 
@@ -197,35 +588,32 @@ double Database::getWarningValue(const QString &table_name, Global::BrakeCategor
 
 double Database::getRefBe(const QString &table_name, int speed, int weight, int temp, int alt)
 {
-    const QString q = QString("SELECT referenceBE FROM %1_RAW_BE WHERE speed = ? AND weight = ? AND temperature = ? AND altitude = ? ").arg(table_name);
-    QSqlQuery query;
-    query.prepare(q);
-    query.addBindValue(speed);
-    query.addBindValue(weight);
-    query.addBindValue(temp);
-    query.addBindValue(alt);
+    BRAKECOOLING_TRACE_SCOPE("sql/ref_be");
+    QSqlQuery &query = preparedQuery(REF_BE_QUERY, table_name);
+    query.bindValue(0, speed);
+    query.bindValue(1, weight);
+    query.bindValue(2, temp);
+    query.bindValue(3, alt);
 
     return executeQuery(query);
 }
 
 double Database::getAdjustedBe(const QString &table_name, int reference_braking_energy, Global::BrakingEvent braking_event, bool rev_t)
 {
-    auto q = QString("SELECT adjustedBE FROM %1_ADJ_BE WHERE refBE = ? AND event = ? AND revT = ?").arg(table_name);
-    QSqlQuery query;
-    query.prepare(q);
-    query.addBindValue(reference_braking_energy);
-    query.addBindValue(static_cast<int>(braking_event));
-    query.addBindValue(rev_t);
+    BRAKECOOLING_TRACE_SCOPE("sql/adjusted_be");
+    QSqlQuery &query = preparedQuery(ADJUSTED_BE_QUERY, table_name);
+    query.bindValue(0, reference_braking_energy);
+    query.bindValue(1, static_cast<int>(braking_event));
+    query.bindValue(2, rev_t);
 
     return executeQuery(query);
 }
 
 double Database::getCoolingTime(const QString &table_name, Global::BrakeCategory brake_category, const double &adjusted_be)
 {
-    auto q = QString("SELECT coolingTime FROM %1_COOLING_TIME WHERE brakeCategory = ? AND adjustedBE = ?").arg(table_name);
-    QSqlQuery query;
-    query.prepare(q);
-    query.addBindValue(static_cast<int>(brake_category));
-    query.addBindValue(adjusted_be);
+    BRAKECOOLING_TRACE_SCOPE("sql/cooling_time");
+    QSqlQuery &query = preparedQuery(COOLING_TIME_QUERY, table_name);
+    query.bindValue(0, static_cast<int>(brake_category));
+    query.bindValue(1, adjusted_be);
     return executeQuery(query);
 }
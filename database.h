@@ -2,6 +2,7 @@
 #define DATABASE_H
 
 #include <QDir>
+#include <QThread>
 #include <QSqlDatabase>
 #include <QSqlDriver>
 #include <QSqlQuery>
@@ -12,25 +13,164 @@
 #include <QSqlField>
 #include <QDebug>
 #include <QStringLiteral>
-#include <QMessageBox>
+#include <functional>
 #include "globals.h"
 #include "libBrakeCooling/include/libBrakeCooling.h"
+#include "libBrakeCooling/include/tableFile.h"
+#include "libBrakeCooling/include/trace.h"
+
+class QWidget;
 
 class Database {
+public:
+    /*!
+     * \brief receives database error messages (rich text). Installed with setErrorHandler()
+     */
+    using ErrorHandler = std::function<void(const QString &error_msg, QWidget *parent)>;
 private:
     const static inline char* DRIVER  = "QSQLITE";
     const static inline char* DB_FILE = "database.db";
     const static inline char* CHECK_QUERY = "SELECT name FROM sqlite_master";
+    const static inline char* THREAD_CONNECTION_OPTIONS = "QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=5000";
+    const static inline char* REF_BE_QUERY = "SELECT referenceBE FROM %1_RAW_BE WHERE speed = ? AND weight = ? AND temperature = ? AND altitude = ?";
+    const static inline char* ADJUSTED_BE_QUERY = "SELECT adjustedBE FROM %1_ADJ_BE WHERE refBE = ? AND event = ? AND revT = ?";
+    const static inline char* COOLING_TIME_QUERY = "SELECT coolingTime FROM %1_COOLING_TIME WHERE brakeCategory = ? AND adjustedBE = ?";
     inline static double executeQuery(QSqlQuery &query);
 
+    /*!
+     * \brief the tables of a model as created by importModel(), with the layout of database/database.db
+     */
+    static inline const char* const MODEL_SCHEMA[] = {
+        "CREATE TABLE \"%1_RAW_BE\" (\"weight\" INTEGER, \"temperature\" INTEGER, \"speed\" INTEGER, "
+        "\"altitude\" INTEGER, \"referenceBE\" REAL)",
+        "CREATE TABLE \"%1_ADJ_BE\" (\"refBE\" INTEGER, \"event\" INTEGER, \"revT\" INTEGER, \"adjustedBE\" REAL)",
+        "CREATE TABLE \"%1_COOLING_TIME\" (\"brakeCategory\" INTEGER, \"adjustedBE\" REAL, \"coolingTime\" REAL)",
+        "CREATE TABLE \"%1_KEYS\" (\"speed\" REAL, \"weight\" REAL, \"temp\" REAL, \"alt\" REAL, "
+        "\"referenceBrakeEnergy\" REAL, \"adjustedBrakeEnergySteel\" REAL, \"adjustedBrakeEnergyCarbon\" REAL)",
+    };
+    static inline const char* const MODEL_TABLES[] = {"%1_RAW_BE", "%1_ADJ_BE", "%1_COOLING_TIME", "%1_KEYS"};
+
+    /*!
+     * \brief covering indexes on the columns of the point lookups, so that the *_QUERY statements are
+     * answered with a single index search instead of a table scan
+     */
+    struct LookupIndex
+    {
+        const char *name;
+        const char *statement;
+    };
+    static inline const LookupIndex LOOKUP_INDEXES[] = {
+        {"%1_RAW_BE_LOOKUP", "CREATE INDEX IF NOT EXISTS \"%1_RAW_BE_LOOKUP\" ON \"%1_RAW_BE\" "
+                             "(speed, weight, temperature, altitude, referenceBE)"},
+        {"%1_ADJ_BE_LOOKUP", "CREATE INDEX IF NOT EXISTS \"%1_ADJ_BE_LOOKUP\" ON \"%1_ADJ_BE\" "
+                             "(refBE, event, revT, adjustedBE)"},
+        {"%1_COOLING_TIME_LOOKUP", "CREATE INDEX IF NOT EXISTS \"%1_COOLING_TIME_LOOKUP\" ON \"%1_COOLING_TIME\" "
+                                   "(brakeCategory, adjustedBE, coolingTime)"},
+    };
+
+    /*!
+     * \brief adds missing lookup indexes to the tables of every model listed in MODELS. Files that
+     * are up to date are not written to, read only files are left as they are.
+     */
+    static void migrate();
+
+    /*!
+     * \brief the prepared statement of the calling thread for query (one of the *_QUERY templates)
+     * and table_name. Statements are prepared on first use and reused afterwards, only the bound
+     * values change between calls.
+     */
+    static QSqlQuery &preparedQuery(const char *query, const QString &table_name);
+    static void clearPreparedQueries();
+
     static void error(const QString &error_msg, QWidget* parent = nullptr);
+    static inline ErrorHandler errorHandler;
+    static inline QString dbFile;
+    static inline QThread *mainThread = nullptr;
 public:
     /*!
      * \brief Establish the database connection
+     * \details The calling thread uses the default connection, which is switched to WAL journaling
+     * if the file is writable, so that readers in other threads are not blocked by a writer.
+     */
+    static bool connect(QWidget* parent = nullptr, const QString &db_file = DB_FILE);
+
+    /*!
+     * \brief closes the connection opened by connect(), from the same thread. The connections of
+     * other threads have to be gone already.
+     */
+    static void disconnect();
+
+    /*!
+     * \brief the connection of the calling thread
+     * \details Every thread other than the one that called connect() lazily opens its own named, read
+     * only connection to the same file, which is removed again when the thread exits. All lookups
+     * use this, so they can be called concurrently from any thread once connect() has returned.
+     */
+    static QSqlDatabase database();
+
+    /*!
+     * \brief the database file passed to connect()
+     */
+    static const QString &getFileName() { return dbFile; }
+
+    /*!
+     * \brief Sets the function errors are reported to. Without a handler, errors are logged with qWarning().
+     * The handler is called on the thread the error occurred in.
      */
-    static bool connect(QWidget* parent = nullptr);
+    static void setErrorHandler(ErrorHandler handler) { errorHandler = std::move(handler); }
+
+    /*!
+     * \brief the models listed in the MODELS table
+     */
+    static QStringList getModelNames();
 
     static std::vector<double> getTableValues(const QString &table_name, Global::Parameter parameter);
+    /*!
+     * \brief loads the complete <model>_RAW_BE table into a dense grid with a single query
+     */
+    static BrakeCooling::ReferenceGrid getReferenceGrid(const QString &table_name);
+
+    /*!
+     * \brief loads all tables of a model, e.g. to compile them with BrakeCooling::TableFile::write().
+     * Table entries missing in the database are NaN.
+     */
+    static BrakeCooling::TableData getTableData(const QString &table_name);
+
+    /*!
+     * \brief the <model>_ADJ_BE table as one curve over ref_be_axis per braking event, in
+     * BrakeCooling::eventIndex() order. Missing entries are NaN.
+     */
+    static std::vector<double> getAdjustedBeTable(const QString &table_name, const BrakeCooling::GridAxis &ref_be_axis);
+
+    /*!
+     * \brief the <model>_COOLING_TIME curve of a brake category over adjusted_axis. Missing entries are NaN.
+     */
+    static std::vector<double> getCoolingTimeTable(const QString &table_name, Global::BrakeCategory brake_category,
+                                                   const BrakeCooling::GridAxis &adjusted_axis);
+
+    /*!
+     * \brief writes the tables of a model and lists it in MODELS, replacing tables of the same name
+     * \details Everything is written in a single transaction on the connection of the calling thread,
+     * which has to be the one that called connect(). data has to be complete, i.e. hold a value for
+     * every corner of the key axes. Before committing, the tables are read back with getTableData()
+     * and compared, so a model is only accepted if it loads exactly as given. Returns false and
+     * sets error otherwise, leaving the database unchanged.
+     */
+    static bool importModel(const QString &model, const QString &table_name, const BrakeCooling::TableData &data,
+                            QString *error = nullptr);
+
+    /*!
+     * \brief the compiled tables file of a model, <model>.bct next to the database file
+     */
+    static QString tableFileName(const QString &table_name);
+
+    /*!
+     * \brief maps the compiled tables of a model. Returns nullptr if there is no file, or if it is
+     * invalid or older than the database or the changes in its write-ahead log, in which case the
+     * tables have to be loaded from the database.
+     */
+    static std::shared_ptr<const BrakeCooling::TableFile> openTableFile(const QString &table_name);
+
     static std::array<double, 16> getReferenceBrakingEnergyValues(
             const QString &table_name,
             const BrakeCooling::Params &speed,
@@ -2,8 +2,14 @@
 #define GLOBALS_H
 #pragma once
 #include <QtCore>
+// debug output is compiled out of release builds, including the formatting of its arguments
+#if defined(QT_NO_DEBUG) || defined(NDEBUG)
+#define DEB while (false) qDebug()
+#define DEB_double while (false) qDebug() << qSetRealNumberPrecision(16)
+#else
 #define DEB qDebug()
 #define DEB_double qDebug() << qSetRealNumberPrecision(16)
+#endif
 
 namespace Global {
 
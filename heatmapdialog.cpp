@@ -0,0 +1,214 @@
+#include "heatmapdialog.h"
+#include <QFormLayout>
+#include <QPainter>
+#include <QVBoxLayout>
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+constexpr int MARGIN = 10;
+constexpr int AXIS_MARGIN = 60;
+
+const QColor NO_PROCEDURE_COLOR(200, 230, 201);
+const QColor CAUTION_COLOR(255, 193, 7);
+const QColor WARNING_COLOR(211, 47, 47);
+
+} // namespace
+
+HeatmapWidget::HeatmapWidget(QWidget *parent)
+    : QWidget(parent)
+{
+    // one pass at a time, a new calculation queues behind the pass in progress
+    m_pool.setMaxThreadCount(1);
+    setMinimumSize(320, 240);
+}
+
+HeatmapWidget::~HeatmapWidget()
+{
+    m_generation++;
+    m_pool.waitForDone();
+}
+
+QSize HeatmapWidget::sizeHint() const
+{
+    return QSize(PASSES[std::size(PASSES) - 1] + AXIS_MARGIN + MARGIN,
+                 int(PASSES[std::size(PASSES) - 1] * ASPECT_RATIO) + AXIS_MARGIN + MARGIN);
+}
+
+void HeatmapWidget::setInputs(std::shared_ptr<const ModelProfile> profile,
+                              const BrakeCooling::LandingInputs &inputs,
+                              Global::BrakeCategory brake_category,
+                              std::size_t event_index)
+{
+    const unsigned generation = ++m_generation;
+    m_inputs = inputs;
+    if (!profile || !profile->hasCompleteTables(brake_category)) {
+        m_image = QImage();
+        m_message = tr("No performance tables available.");
+        update();
+        return;
+    }
+
+    const auto &grid = profile->getReferenceGrid();
+    m_speed_range[0]  = grid.getSpeeds().front();
+    m_speed_range[1]  = grid.getSpeeds().back();
+    m_weight_range[0] = grid.getWeights().front() * 1000;
+    m_weight_range[1] = grid.getWeights().back() * 1000;
+    update();
+
+    // the tables point into the profile, which the worker keeps alive
+    const auto tables = profile->getPerformanceTables(brake_category);
+    const std::array<double, 2> speed_range  = {m_speed_range[0], m_speed_range[1]};
+    const std::array<double, 2> weight_range = {m_weight_range[0], m_weight_range[1]};
+    m_pool.start([this, profile, tables, inputs, event_index, generation, speed_range, weight_range]() {
+        for (const int columns : PASSES) {
+            if (generation != m_generation)
+                return;
+            const QImage image = render(tables, inputs, event_index, columns, speed_range.data(), weight_range.data());
+            QMetaObject::invokeMethod(this, [this, image, generation]() {
+                if (generation != m_generation)
+                    return;
+                m_image = image;
+                update();
+            }, Qt::QueuedConnection);
+        }
+    });
+}
+
+QImage HeatmapWidget::render(const BrakeCooling::PerformanceTables &tables,
+                             const BrakeCooling::LandingInputs &inputs,
+                             std::size_t event_index,
+                             int columns,
+                             const double speed_range[2],
+                             const double weight_range[2])
+{
+    const int rows = std::max(1, int(columns * ASPECT_RATIO));
+    std::vector<BrakeCooling::LandingInputs> landings(std::size_t(columns) * rows, inputs);
+    for (int y = 0; y < rows; y++) {
+        for (int x = 0; x < columns; x++) {
+            // the centre of every pixel, so all passes cover the same area
+            auto &landing = landings[std::size_t(y) * columns + x];
+            landing.speed  = speed_range[0] + (speed_range[1] - speed_range[0]) * (x + 0.5) / columns;
+            landing.weight = weight_range[1] - (weight_range[1] - weight_range[0]) * (y + 0.5) / rows;
+        }
+    }
+    std::vector<BrakeCooling::LandingResult> results(landings.size());
+    BrakeCooling::evaluateLandings(tables, landings.data(), results.data(), landings.size());
+
+    const auto &cooling_times = tables.cooling_time->getValues();
+    const double max_cooling_time = *std::max_element(cooling_times.begin(), cooling_times.end());
+    QImage image(columns, rows, QImage::Format_RGB32);
+    for (int y = 0; y < rows; y++) {
+        auto *line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < columns; x++)
+            line[x] = color(results[std::size_t(y) * columns + x].events[event_index], max_cooling_time).rgb();
+    }
+    return image;
+}
+
+QColor HeatmapWidget::color(const BrakeCooling::EventResult &result, double max_cooling_time)
+{
+    switch (result.band) {
+    case BrakeCooling::CoolingBand::NoProcedure:
+        return NO_PROCEDURE_COLOR;
+    case BrakeCooling::CoolingBand::Caution:
+        return CAUTION_COLOR;
+    case BrakeCooling::CoolingBand::Warning:
+        return WARNING_COLOR;
+    case BrakeCooling::CoolingBand::Cooling:
+        break;
+    }
+    // from light to dark blue with increasing cooling time
+    const double t = max_cooling_time > 0 ? std::clamp(result.cooling_time / max_cooling_time, 0.0, 1.0) : 1.0;
+    return QColor::fromHsvF(0.58, 0.25 + 0.7 * t, 1.0 - 0.45 * t);
+}
+
+void HeatmapWidget::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    if (m_image.isNull()) {
+        painter.drawText(rect(), Qt::AlignCenter, m_message);
+        return;
+    }
+
+    const QRect plot = rect().adjusted(AXIS_MARGIN, MARGIN, -MARGIN, -AXIS_MARGIN);
+    // scaled without smoothing, coarse passes show as blocks
+    painter.drawImage(plot, m_image);
+    painter.setPen(palette().color(QPalette::WindowText));
+    painter.drawRect(plot.adjusted(0, 0, -1, -1));
+
+    const int text_height = painter.fontMetrics().height();
+    const QRect speed_labels(plot.left(), plot.bottom() + 4, plot.width(), text_height);
+    painter.drawText(speed_labels, Qt::AlignLeft, QString::number(m_speed_range[0]));
+    painter.drawText(speed_labels, Qt::AlignRight, QString::number(m_speed_range[1]));
+    painter.drawText(speed_labels.translated(0, text_height), Qt::AlignHCenter, tr("Speed (kt)"));
+    const QRect weight_labels(0, plot.top(), AXIS_MARGIN - 4, plot.height());
+    painter.drawText(weight_labels, Qt::AlignRight | Qt::AlignTop, QString::number(m_weight_range[1]));
+    painter.drawText(weight_labels, Qt::AlignRight | Qt::AlignBottom, QString::number(m_weight_range[0]));
+    painter.drawText(weight_labels, Qt::AlignRight | Qt::AlignVCenter, tr("Weight\n(kg)"));
+
+    // the landing entered in the main window
+    const double x = (m_inputs.speed - m_speed_range[0]) / (m_speed_range[1] - m_speed_range[0]);
+    const double y = (m_inputs.weight - m_weight_range[0]) / (m_weight_range[1] - m_weight_range[0]);
+    if (x >= 0 && x <= 1 && y >= 0 && y <= 1) {
+        const QPoint marker(plot.left() + int(x * plot.width()), plot.bottom() - int(y * plot.height()));
+        painter.setPen(QPen(Qt::black, 2));
+        painter.drawLine(marker - QPoint(6, 0), marker + QPoint(6, 0));
+        painter.drawLine(marker - QPoint(0, 6), marker + QPoint(0, 6));
+    }
+}
+
+HeatmapDialog::HeatmapDialog(QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle(tr("Cooling Time Envelope"));
+
+    m_event_combo_box = new QComboBox(this);
+    for (const bool rev_t : {false, true})
+        for (auto it = Global::BRAKING_EVENT_DISPLAY_NAMES.cbegin(); it != Global::BRAKING_EVENT_DISPLAY_NAMES.cend(); ++it)
+            m_event_combo_box->addItem(QString(it.value()) + " - " + Global::REVERSE_THRUST_DISPLAY_NAMES.value(rev_t),
+                                       int(BrakeCooling::eventIndex(BrakeCooling::BrakingEvent(it.key()), rev_t)));
+    QObject::connect(m_event_combo_box, qOverload<int>(&QComboBox::currentIndexChanged), this, &HeatmapDialog::refresh);
+
+    m_heatmap = new HeatmapWidget(this);
+
+    const auto swatch = [](const QColor &color) {
+        return QStringLiteral("<span style=\"color:%1\">&#9632;</span>").arg(color.name());
+    };
+    auto *legend = new QLabel(tr("%1 no special procedure &nbsp; %2 %3 cooling time, short to long &nbsp; "
+                                 "%4 caution &nbsp; %5 warning")
+                              .arg(swatch(NO_PROCEDURE_COLOR), swatch(HeatmapWidget::color({0, 0, BrakeCooling::CoolingBand::Cooling}, 1)),
+                                   swatch(HeatmapWidget::color({0, 1, BrakeCooling::CoolingBand::Cooling}, 1)),
+                                   swatch(CAUTION_COLOR), swatch(WARNING_COLOR)), this);
+    legend->setTextFormat(Qt::RichText);
+    m_conditions_label = new QLabel(this);
+
+    auto *form = new QFormLayout;
+    form->addRow(tr("Braking Event"), m_event_combo_box);
+    auto *layout = new QVBoxLayout(this);
+    layout->addLayout(form);
+    layout->addWidget(m_heatmap, 1);
+    layout->addWidget(legend);
+    layout->addWidget(m_conditions_label);
+}
+
+void HeatmapDialog::setInputs(std::shared_ptr<const ModelProfile> profile,
+                              const BrakeCooling::LandingInputs &inputs,
+                              Global::BrakeCategory brake_category)
+{
+    m_profile = std::move(profile);
+    m_inputs = inputs;
+    m_brake_category = brake_category;
+    refresh();
+}
+
+void HeatmapDialog::refresh()
+{
+    m_conditions_label->setText(tr("%1, %2 °C, %3 ft, taxi distance %4 miles, %5")
+                                .arg(m_profile ? m_profile->getName() : QString())
+                                .arg(m_inputs.temp).arg(m_inputs.alt).arg(m_inputs.taxi_distance)
+                                .arg(QString(Global::BRAKE_CATEGORY_DISPLAY_NAMES.value(m_brake_category))));
+    m_heatmap->setInputs(m_profile, m_inputs, m_brake_category,
+                         std::size_t(m_event_combo_box->currentData().toInt()));
+}
@@ -0,0 +1,101 @@
+#ifndef HEATMAPDIALOG_H
+#define HEATMAPDIALOG_H
+
+#include <QDialog>
+#include <QComboBox>
+#include <QImage>
+#include <QLabel>
+#include <QThreadPool>
+#include <atomic>
+#include "calculation.h"
+
+/*!
+ * \brief Paints the cooling time of one braking event over the speed and weight range of a model
+ * \details The map is calculated on a worker thread with BrakeCooling::evaluateLandings(), without
+ * database lookups, in passes of increasing resolution. Every pass replaces the image as soon as it
+ * is done, so a coarse map appears immediately. New inputs abandon a calculation in progress after
+ * its current pass. The speed and weight of the inputs are marked on the map.
+ */
+class HeatmapWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit HeatmapWidget(QWidget *parent = nullptr);
+    ~HeatmapWidget() override;
+
+    /*!
+     * \brief recalculates the map at the temperature, altitude and taxi distance of inputs.
+     * event_index selects the braking event, see BrakeCooling::eventIndex().
+     */
+    void setInputs(std::shared_ptr<const ModelProfile> profile,
+                   const BrakeCooling::LandingInputs &inputs,
+                   Global::BrakeCategory brake_category,
+                   std::size_t event_index);
+
+    /*!
+     * \brief the colour of a result on the map, cooling times are shaded up to max_cooling_time
+     */
+    static QColor color(const BrakeCooling::EventResult &result, double max_cooling_time);
+
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    // columns of the passes, the rows follow from ASPECT_RATIO
+    static constexpr int PASSES[] = {24, 96, 384};
+    static constexpr double ASPECT_RATIO = 0.75;
+
+    /*!
+     * \brief calculates one pass, the top row is the largest weight
+     */
+    static QImage render(const BrakeCooling::PerformanceTables &tables,
+                         const BrakeCooling::LandingInputs &inputs,
+                         std::size_t event_index,
+                         int columns,
+                         const double speed_range[2],
+                         const double weight_range[2]);
+
+    QThreadPool m_pool;
+    // incremented by every setInputs(), passes of older generations are discarded
+    std::atomic<unsigned> m_generation{0};
+
+    QImage m_image;
+    QString m_message;
+    BrakeCooling::LandingInputs m_inputs;
+    // the ranges of m_image, speed in kt and weight in kg
+    double m_speed_range[2] = {0, 0};
+    double m_weight_range[2] = {0, 0};
+};
+
+/*!
+ * \brief Non-modal window around a HeatmapWidget, following the inputs of the main window
+ */
+class HeatmapDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit HeatmapDialog(QWidget *parent = nullptr);
+
+    /*!
+     * \brief redraws the map for the inputs and brake category of the main window
+     */
+    void setInputs(std::shared_ptr<const ModelProfile> profile,
+                   const BrakeCooling::LandingInputs &inputs,
+                   Global::BrakeCategory brake_category);
+
+private slots:
+    void refresh();
+
+private:
+    std::shared_ptr<const ModelProfile> m_profile;
+    BrakeCooling::LandingInputs m_inputs;
+    Global::BrakeCategory m_brake_category = Global::BrakeCategory::Steel;
+
+    QComboBox *m_event_combo_box;
+    HeatmapWidget *m_heatmap;
+    QLabel *m_conditions_label;
+};
+
+#endif // HEATMAPDIALOG_H
@@ -0,0 +1,64 @@
+#pragma once
+#include <vector>
+#include "performanceTables.h"
+
+namespace BrakeCooling {
+
+/*!
+ * \brief one landing of a tail and the ground time following it
+ */
+struct Sector
+{
+    LandingInputs landing;
+    BrakingEvent event = BrakingEvent::Ab2;
+    bool rev_t = false;
+    double ground_time = std::numeric_limits<double>::infinity(); // minutes until the next departure
+};
+
+/*!
+ * \brief the sectors one tail flies on one day, in order. The brakes are taken as cold at the
+ * start of the day.
+ */
+struct TailDay
+{
+    const PerformanceTables *tables = nullptr; // of the model and brake category of the tail, complete
+    std::vector<Sector> sectors;
+};
+
+/*!
+ * \brief the outcome of one landing and the turn following it
+ * \details result holds the adjusted brake energy including the residual energy carried in from
+ * the previous sectors, and the cooling time or band required for it. A turn is flagged when the
+ * landing is in the caution or warning band, or needs a longer cooling time than the ground time.
+ */
+struct TurnResult
+{
+    double residual_be = 0; // adjusted brake energy left from previous sectors
+    EventResult result;
+    bool in_envelope = true;
+    bool flagged = false;
+};
+
+/*!
+ * \brief the adjusted brake energy left after cooling for ground_time minutes
+ * \details Read off the cooling time curve: the brakes need the cooling time of adjusted_be, so
+ * after the ground time they hold the energy whose cooling time is the time still missing. Energy
+ * needing no cooling time is taken as dissipated during any ground time. Above the caution value,
+ * where the schedule gives no cooling time, the curve is extended with the slope of its last
+ * segment.
+ */
+double residualBrakeEnergy(const PerformanceTables &tables, const double &adjusted_be, const double &ground_time);
+
+/*!
+ * \brief simulates the sectors of every tail day, carrying the brake energy from one landing to
+ * the next
+ * \details Tail days are independent and are dealt out to threads round robin, each writing only
+ * the results of its own tail days. threads = 0 uses all cores. The results are indexed like
+ * tail_days, with one TurnResult per sector. A landing above the reference brake energy axis is in the
+ * warning band (see adjustedBrakeEnergy()), and as its energy is unknown, so are the later landings of
+ * its day. A tail day without tables is not simulated, all its
+ * turns are flagged and marked as outside of the envelope.
+ */
+std::vector<std::vector<TurnResult>> simulateFleet(const std::vector<TailDay> &tail_days, unsigned threads = 0);
+
+} // namespace BrakeCooling
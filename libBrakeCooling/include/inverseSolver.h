@@ -0,0 +1,58 @@
+#pragma once
+#include "performanceTables.h"
+
+namespace BrakeCooling {
+
+/*!
+ * \brief the input an inverse problem solves for
+ */
+enum class SolveParameter {Weight, Speed};
+
+/*!
+ * \brief the condition the solved input has to keep
+ * \details CoolingTime keeps the cooling time at or below a number of minutes (and thus out of the
+ * caution band), NoCaution and NoWarning keep the adjusted brake energy out of the respective band.
+ */
+enum class SolveTarget {CoolingTime, NoCaution, NoWarning};
+
+/*!
+ * \brief enumerates the outcomes of an inverse problem for one braking event
+ * \details Limited - the target is met up to the limit and missed right above it
+ * Unlimited - the target is met over the whole table range, the limit is the largest key value
+ * Infeasible - the target is missed even at the smallest key value, the limit is NaN
+ */
+enum class SolveStatus {Limited, Unlimited, Infeasible};
+
+struct InverseProblem
+{
+    LandingInputs inputs; // the solved parameter is ignored
+    SolveParameter parameter = SolveParameter::Weight;
+    SolveTarget target = SolveTarget::CoolingTime;
+    double max_cooling_time = 0; // minutes, for SolveTarget::CoolingTime
+};
+
+struct InverseResult
+{
+    double limit = std::numeric_limits<double>::quiet_NaN(); // in the units of LandingInputs
+    SolveStatus status = SolveStatus::Infeasible;
+};
+
+/*!
+ * \brief the results of all braking events, indexed with eventIndex()
+ */
+using InverseResults = std::array<InverseResult, 10>;
+
+/*!
+ * \brief finds the largest weight or speed meeting a target, for all braking events in one pass
+ * \details With all other inputs fixed, every stage of the forward calculation is piecewise linear
+ * in the solved parameter: the reference brake energy between its key values, the adjusted brake
+ * energy between the reference brake energy keys and the cooling time between the adjusted brake
+ * energy keys. The solver collects these breakpoints, evaluates the forward chain only there and
+ * inverts the linear segment the target is crossed in, so the limit is exact rather than a
+ * result of stepping. The targets are assumed to be crossed upwards, i.e. heavier and faster
+ * landings need longer cooling. A reference brake energy above the last key misses every target (see
+ * adjustedBrakeEnergy()), so no limit lies beyond the point where the tables end.
+ */
+InverseResults solveInverse(const PerformanceTables &tables, const InverseProblem &problem);
+
+} // namespace BrakeCooling
@@ -2,6 +2,10 @@
 #include <vector>
 #include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
 
 namespace BrakeCooling {
 
@@ -12,10 +16,60 @@ enum class BrakingEvent {MaxMan = 0, AbMax = 1, Ab3 = 2, Ab2 = 3, Ab1 = 4};
 
 enum class BrakeCategory {Steel = 0, Carbon = 1};
 
+/*!
+ * \brief enumerates the outcomes of a cooling time calculation for one braking event
+ * \details NoProcedure - no special procedure required, Cooling - wait for the cooling time,
+ * Caution and Warning - adjusted brake energy in the caution or warning band of the schedule
+ */
+enum class CoolingBand {NoProcedure = 0, Cooling = 1, Caution = 2, Warning = 3};
+
+/*!
+ * \brief result of the calculation for one braking event and reverse thrust setting
+ */
+struct EventResult
+{
+    double adjusted_be = 0;
+    double cooling_time = -1; // minutes, only valid in CoolingBand::Cooling
+    CoolingBand band = CoolingBand::NoProcedure;
+};
+
+/*!
+ * \brief results for all braking events, the five idle reverse events first, followed by
+ * the five second detent events. Index with eventIndex()
+ */
+using EventResults = std::array<EventResult, 10>;
+
+inline constexpr std::size_t eventIndex(BrakingEvent event, bool rev_t)
+{
+    return (rev_t ? 5 : 0) + static_cast<std::size_t>(event);
+}
+
+/*!
+ * \brief the conditions of one landing, in the units of the user interface (kt, kg, °C, ft)
+ */
+struct LandingInputs
+{
+    double speed = 0;
+    double weight = 0;
+    double temp = 0;
+    double alt = 0;
+    double taxi_distance = 0;
+};
+
+/*!
+ * \brief the complete result of the calculation for one landing
+ */
+struct LandingResult
+{
+    double reference_be = 0; // including the taxi distance allowance
+    bool in_envelope = true; // false if an input was outside of the tables and has been clamped
+    EventResults events;
+};
+
 /*!
  * \brief performs linear interpolation
  */
-inline double linearInterpol(const double parameter_in,
+constexpr inline double linearInterpol(const double parameter_in,
                              const double &parameter_low, const double &value_low,
                              const double &parameter_high, const double &value_high)
 {
@@ -27,39 +81,316 @@ inline double linearInterpol(const double parameter_in,
  */
 struct Values
 {
-    Values(const double &low, const double &high, const double &param)
+    constexpr Values(const double &low, const double &high, const double &param)
     : low_border(low), high_border(high), input_parameter(param) {;}
     double low_border;
     double high_border;
     double input_parameter;
 };
 
+/*!
+ * \brief enumerates how an input parameter relates to the key values of an axis
+ * \details ClampedLow and ClampedHigh mean the input is outside of the envelope covered by the table
+ * and has been replaced by the first or last key value.
+ */
+enum class AxisStatus {Exact, Interpolated, ClampedLow, ClampedHigh};
+
+/*!
+ * \brief position of an input parameter on a GridAxis
+ */
+struct AxisBracket
+{
+    std::size_t low_index;
+    std::size_t high_index;
+    double low_border;
+    double high_border;
+    double parameter; // the input parameter, clamped to the axis
+    AxisStatus status;
+
+    bool isOutOfEnvelope() const {return status == AxisStatus::ClampedLow || status == AxisStatus::ClampedHigh;}
+};
+
+/*!
+ * \brief The ascending key values of one table parameter, prepared for fast lookups
+ * \details Axes with a constant step (e.g. the weight in 500 kg steps) are bracketed arithmetically in
+ * constant time, all others with a binary search.
+ */
+class GridAxis
+{
+public:
+    GridAxis() = default;
+    explicit GridAxis(const std::vector<double> &values);
+
+    const std::vector<double> &getValues() const {return m_values;}
+    std::size_t size() const {return m_values.size();}
+    bool isEmpty() const {return m_values.empty();}
+    bool isUniform() const {return m_uniform;}
+    double operator[](std::size_t index) const {return m_values[index];}
+
+    /*!
+     * \brief finds the key values enclosing parameter_in. Inputs outside of the axis are clamped,
+     * which is reported in the status. An empty axis yields NaN borders.
+     */
+    AxisBracket bracket(const double &parameter_in) const;
+
+    /*!
+     * \brief returns the position of a key value, or size() if value is not a key
+     */
+    std::size_t indexOf(const double &value) const;
+private:
+    std::vector<double> m_values;
+    bool m_uniform = false;
+    double m_inverse_step = 0;
+};
+
+/*!
+ * \brief A piecewise linear curve over the key values of a GridAxis, e.g. one event of <model>_ADJ_BE
+ * \details Holds the value and the slope towards the next key for every key value, so an evaluation
+ * is one bracket search and one multiply-add. Inputs outside of the axis are clamped, and inputs on
+ * a key value yield the stored value exactly.
+ */
+class Curve1D
+{
+public:
+    Curve1D() = default;
+    Curve1D(const GridAxis &axis, const double *values);
+
+    const GridAxis &getAxis() const {return m_axis;}
+    const std::vector<double> &getValues() const {return m_values;}
+    double getSlope(std::size_t index) const {return m_slopes[index];}
+    bool isEmpty() const {return m_values.empty();}
+
+    /*!
+     * \brief false if the curve is empty or a value is missing (NaN)
+     */
+    bool isComplete() const;
+
+    /*!
+     * \brief evaluates the curve at a bracket found on getAxis(), or on another axis with the same
+     * key values. Curves sharing an axis can thus be evaluated with a single bracket search.
+     */
+    double evaluate(const AxisBracket &bracket) const
+    {
+        return m_values[bracket.low_index] + m_slopes[bracket.low_index] * (bracket.parameter - bracket.low_border);
+    }
+
+    double operator()(const double &x) const
+    {
+        return isEmpty() ? std::numeric_limits<double>::quiet_NaN() : evaluate(m_axis.bracket(x));
+    }
+private:
+    GridAxis m_axis;
+    std::vector<double> m_values;
+    std::vector<double> m_slopes; // towards the next key value, 0 for the last one
+};
+
 /*!
  * \brief Base class for the parameters affecting the calculation (speed, weight, temperature, altitude)
  * \details A Parameter is received as an exact doubleing point value. This value is then compared against
  * a set of values for which data points exist in the table. The high and low values corresponding
- * to the next closest value in the allowable input range can be retreived with getValues()
+ * to the next closest value in the allowable input range can be retreived with getValues(). Values
+ * outside of the table are clamped to its first or last value, see getStatus().
  */
 class Params
 {
 public:
     Params() = delete;
+    Params(const double &parameter_in, const GridAxis &axis);
     Params(const double &parameter_in, const std::vector<double> &table_values);
 
     double getLowBorder()  const {return m_low_border;}
     double getHighBorder() const {return m_high_border;}
     double getInputParameter() const {return m_input_parameter;}
+    AxisStatus getStatus() const {return m_status;}
+    bool isOutOfEnvelope() const {return m_status == AxisStatus::ClampedLow || m_status == AxisStatus::ClampedHigh;}
 
     Values getValues() const {return Values(m_low_border, m_high_border, m_input_parameter);}
 private:
     double m_input_parameter;
     double m_low_border;
     double m_high_border;
+    AxisStatus m_status;
+};
+
+/*!
+ * \brief Multilinear interpolation between the 2^N corners of an N-dimensional table cell
+ * \details Bit n of a corner's index selects the low(0) or high(1) border of dimension n, the same
+ * order Interpol and ReferenceGrid use. The weight of every dimension is calculated once, then the
+ * dimensions are reduced one after another, starting with dimension 0, each halving the number of
+ * values. The recursion is resolved at compile time and the reduction has no branches, so every
+ * instantiation compiles to a fixed sequence of multiply-adds. A dimension of zero width, i.e. an input
+ * on a key value, has the weight 0 and carries the low values forward.
+ */
+template <std::size_t N>
+class MultilinearInterpol
+{
+public:
+    static constexpr std::size_t CORNERS = std::size_t(1) << N;
+
+    /*!
+     * \brief interpolates with the borders and input parameter of every dimension
+     */
+    static constexpr double interpolate(const std::array<Values, N> &parameters,
+                                        const std::array<double, CORNERS> &corners)
+    {
+        std::array<double, N> weights{};
+        for (std::size_t d = 0; d < N; d++)
+            weights[d] = weight(parameters[d]);
+        return reduce<0>(weights, corners);
+    }
+
+    /*!
+     * \brief the position of the input parameter between the borders, 0 on the low and 1 on the high border
+     */
+    static constexpr double weight(const Values &p)
+    {
+        return p.high_border == p.low_border ? 0 : (p.input_parameter - p.low_border) / (p.high_border - p.low_border);
+    }
+
+private:
+    template <std::size_t D>
+    static constexpr double reduce(const std::array<double, N> &weights,
+                                   const std::array<double, (CORNERS >> D)> &values)
+    {
+        if constexpr (D == N) {
+            return values[0];
+        } else {
+            const double t = weights[D];
+            std::array<double, (CORNERS >> (D + 1))> reduced{};
+            for (std::size_t i = 0; i < reduced.size(); i++)
+                reduced[i] = values[2*i] + t * (values[2*i + 1] - values[2*i]);
+            return reduce<D + 1>(weights, reduced);
+        }
+    }
+};
+
+/*!
+ * \brief number format of the values of a ReferenceGrid
+ * \details Float32 halves the memory of a grid at a relative error of about 6e-8. Fixed16 and Fixed32
+ * store every value as a multiple of one scale, centred on the value range of the grid, which gives an
+ * absolute error of at most half a step: (max - min) / 131068 for Fixed16. The smallest integer
+ * marks a node that has not been set.
+ */
+enum class GridStorage {Double = 0, Float32 = 1, Fixed16 = 2, Fixed32 = 3};
+
+/*!
+ * \brief Dense 4-dimensional table of reference braking energies
+ * \details Holds a complete <model>_RAW_BE table in one contiguous array, addressed by the position
+ * of each parameter on its key axis. Speed varies fastest, followed by weight, temperature and altitude,
+ * which is the same order Interpol expects its 16 corners in. Nodes that have not been set are NaN.
+ * The values are either owned by the grid or used in place from external storage, such as a mapped
+ * TableFile. Copies of a grid share its values. withStorage() creates a read only copy in a more
+ * compact number format, whose values are converted back to double when read.
+ */
+class ReferenceGrid
+{
+public:
+    ReferenceGrid() = default;
+    ReferenceGrid(const std::vector<double> &speeds,
+                  const std::vector<double> &weights,
+                  const std::vector<double> &temps,
+                  const std::vector<double> &alts);
+    /*!
+     * \brief creates a read only grid using values in place. storage keeps the values alive.
+     */
+    ReferenceGrid(const std::vector<double> &speeds,
+                  const std::vector<double> &weights,
+                  const std::vector<double> &temps,
+                  const std::vector<double> &alts,
+                  const double *values,
+                  std::shared_ptr<const void> storage);
+
+    const std::vector<double> &getSpeeds()  const {return m_speeds.getValues();}
+    const std::vector<double> &getWeights() const {return m_weights.getValues();}
+    const std::vector<double> &getTemps()   const {return m_temps.getValues();}
+    const std::vector<double> &getAlts()    const {return m_alts.getValues();}
+
+    const GridAxis &getSpeedAxis()  const {return m_speeds;}
+    const GridAxis &getWeightAxis() const {return m_weights;}
+    const GridAxis &getTempAxis()   const {return m_temps;}
+    const GridAxis &getAltAxis()    const {return m_alts;}
+
+    bool isEmpty() const {return m_size == 0;}
+    bool isComplete() const;
+
+    /*!
+     * \brief all values, speed varying fastest. nullptr unless the grid uses GridStorage::Double.
+     */
+    const double *getValues() const {return m_values;}
+    std::size_t getValueCount() const {return m_size;}
+
+    GridStorage getStorage() const {return m_format;}
+
+    /*!
+     * \brief the number of bytes taken by the values
+     */
+    std::size_t getStorageSize() const;
+
+    /*!
+     * \brief a read only copy of the grid with its values converted to another number format
+     */
+    ReferenceGrid withStorage(GridStorage storage) const;
+
+    /*!
+     * \brief stores a reference braking energy. Returns false if the parameters are not on the grid
+     * or the grid is read only.
+     */
+    bool setValue(const double &speed, const double &weight, const double &temp, const double &alt, const double &ref_be);
+
+    double getValue(std::size_t speed_index, std::size_t weight_index, std::size_t temp_index, std::size_t alt_index) const
+    {
+        return valueAt(offset(speed_index, weight_index, temp_index, alt_index));
+    }
+
+    /*!
+     * \brief gathers the 16 corners of the hypercube enclosing the input parameters.
+     * \details The n-th least significant bit of the index determines if parameter n is high(1) or low(0)
+     */
+    std::array<double, 16> getCorners(const Params &speed, const Params &weight, const Params &temp, const Params &alt) const;
+private:
+    std::size_t offset(std::size_t speed_index, std::size_t weight_index, std::size_t temp_index, std::size_t alt_index) const
+    {
+        return ((alt_index * m_temps.size() + temp_index) * m_weights.size() + weight_index) * m_speeds.size() + speed_index;
+    }
+
+    double valueAt(std::size_t index) const
+    {
+        switch (m_format) {
+        case GridStorage::Float32: return static_cast<const float*>(m_compact_values)[index];
+        case GridStorage::Fixed16: return fixedValue(static_cast<const std::int16_t*>(m_compact_values)[index]);
+        case GridStorage::Fixed32: return fixedValue(static_cast<const std::int32_t*>(m_compact_values)[index]);
+        default:                   return m_values[index];
+        }
+    }
+
+    template <typename T>
+    double fixedValue(T value) const
+    {
+        return value == std::numeric_limits<T>::min() ? std::numeric_limits<double>::quiet_NaN()
+                                                      : m_fixed_offset + m_fixed_scale * value;
+    }
+
+    template <typename T>
+    void quantize(ReferenceGrid &grid) const;
+
+    GridAxis m_speeds;
+    GridAxis m_weights;
+    GridAxis m_temps;
+    GridAxis m_alts;
+    std::shared_ptr<const void> m_storage;
+    const double *m_values = nullptr;
+    double *m_writable_values = nullptr; // nullptr for read only grids
+    std::size_t m_size = 0;
+    GridStorage m_format = GridStorage::Double;
+    const void *m_compact_values = nullptr; // the values unless m_format is Double
+    double m_fixed_scale = 1;
+    double m_fixed_offset = 0;
 };
 
 /*!
  * \brief Interpolates a reference braking energy value from the raw input parameters
-   \details todo, input array, drill down
+ * \details The 16 corners surrounding the input are reduced with MultilinearInterpol<4>,
+ * in the order speed, weight, temperature and altitude
  */
 class Interpol 
 {
@@ -70,21 +401,30 @@ public:
              const Params &temp, 
              const Params &alt,
              const std::array<double, 16> &raw_ref_be);
+    Interpol(const Params &speed,
+             const Params &weight,
+             const Params &temp,
+             const Params &alt,
+             const ReferenceGrid &grid)
+        : Interpol(speed, weight, temp, alt, grid.getCorners(speed, weight, temp, alt)) {}
     double getReferenceBrakingEnergy() const { return m_interpolation;}
 private:
-    const std::array<double, 8> correctSpeed(const std::array<double, 16> &raw_braking_energy,
-                                             const double &speed_param, 
-                                             const double &speed_low, 
-                                             const double &speed_high) const;
-    const std::array<double, 4> correctWeight(const std::array<double, 8> &speed_corrected_be,
-                                             const double &weight_param,
-                                             const double &weight_low,
-                                             const double &weight_high) const;
-    const std::array<double, 2> correctTemperature(const std::array<double, 4> &weight_corrected_be,
-                                                  const double &temp_param,
-                                                  const double &temp_low,
-                                                  const double &temp_high) const;
     double m_interpolation = 0;
 };
 
+/*!
+ * \brief interpolates reference braking energies for a batch of inputs
+ * \details The inputs are passed as structure of arrays, each holding count elements, and one reference
+ * braking energy is written to ref_be per element. The kernel is vectorised (AVX2 or SSE2, with a scalar
+ * fallback, selected at runtime) and produces results identical to Interpol, including the clamping of inputs
+ * outside of the key axes.
+ */
+void interpolateBatch(const ReferenceGrid &grid,
+                      const double *speeds,
+                      const double *weights,
+                      const double *temps,
+                      const double *alts,
+                      double *ref_be,
+                      std::size_t count);
+
 } // namespace BrakeCooling
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include "performanceTables.h"
+
+namespace BrakeCooling {
+
+/*!
+ * \brief enumerates the distributions an uncertain input can be sampled from
+ * \details Fixed - always the mean, Normal - spread is the standard deviation, Uniform - spread is
+ * the half width of the interval around the mean
+ */
+enum class DistributionType {Fixed, Normal, Uniform};
+
+struct InputDistribution
+{
+    DistributionType type = DistributionType::Fixed;
+    double mean = 0;
+    double spread = 0;
+};
+
+/*!
+ * \brief the distributions of the landing inputs, in the units of LandingInputs
+ */
+struct UncertainInputs
+{
+    InputDistribution speed;
+    InputDistribution weight;
+    InputDistribution temp;
+    InputDistribution alt;
+    InputDistribution taxi_distance; // samples below zero are taken as zero
+};
+
+struct MonteCarloSettings
+{
+    std::size_t samples = 200000;
+    unsigned threads = 0; // 0 uses all cores
+    std::uint64_t seed = 1;
+};
+
+/*!
+ * \brief the outcome distribution of one braking event
+ * \details The percentiles are taken over the cooling times of all samples, counting samples
+ * needing no special procedure as 0 minutes and samples in the caution or warning band as
+ * infinitely long. A percentile of infinity thus means that more samples than the percentile leaves
+ * out ended up in one of the bands.
+ */
+struct EventStatistics
+{
+    double p50 = std::numeric_limits<double>::quiet_NaN();
+    double p90 = std::numeric_limits<double>::quiet_NaN();
+    double p99 = std::numeric_limits<double>::quiet_NaN();
+    double caution_probability = 0; // caution band only, not including warning
+    double warning_probability = 0;
+};
+
+struct MonteCarloResult
+{
+    std::array<EventStatistics, 10> events; // indexed with eventIndex()
+    std::size_t samples = 0;
+    double out_of_envelope_probability = 0; // samples clamped to the edge of the tables
+};
+
+/*!
+ * \brief samples the inputs and runs every sample through evaluateLanding(), spread over threads
+ * \details Samples are drawn in fixed blocks, each with its own random generator seeded from the
+ * seed and the block number, and the blocks are dealt out to the threads round robin. Threads
+ * share nothing but the read-only tables and write to disjoint parts of the preallocated outcome
+ * buffer, and the results only depend on the seed and the number of samples, not on the number of
+ * threads.
+ */
+MonteCarloResult runMonteCarlo(const PerformanceTables &tables,
+                               const UncertainInputs &inputs,
+                               const MonteCarloSettings &settings);
+
+} // namespace BrakeCooling
@@ -0,0 +1,92 @@
+#pragma once
+#include "libBrakeCooling.h"
+
+namespace BrakeCooling {
+
+/*!
+ * \brief the in-memory tables of one model and brake category
+ * \details adjusted_be points to the ten adjusted brake energy curves in eventIndex() order, which
+ * share the reference brake energy axis, cooling_time to the cooling time curve. The tables are not
+ * owned, all pointers have to stay valid while the struct is used.
+ */
+struct PerformanceTables
+{
+    const ReferenceGrid *grid = nullptr;
+    const Curve1D *adjusted_be = nullptr;
+    const Curve1D *cooling_time = nullptr;
+    double caution_value = 0;
+    double warning_value = 0;
+};
+
+/*!
+ * \brief interpolates the reference brake energy and adds the taxi distance allowance. If
+ * in_envelope is given, it is set to false when an input is outside of the grid and has been clamped.
+ */
+double referenceBrakeEnergy(const PerformanceTables &tables, const LandingInputs &inputs, bool *in_envelope = nullptr);
+
+/*!
+ * \brief the cooling time or band of one braking event from its adjusted brake energy
+ */
+EventResult evaluateEvent(const PerformanceTables &tables, const double &adjusted_be);
+
+/*!
+ * \brief the adjusted brake energy of one braking event (see eventIndex()) for a reference brake energy
+ * \details Above the last key of the reference brake energy axis the tables give no adjusted brake
+ * energy, the curves are not extrapolated. Such a reference brake energy, e.g. raised by the taxi
+ * distance allowance, is +infinity for every event and so in the warning band, instead of being
+ * clamped to the last key, which would understate it.
+ */
+double adjustedBrakeEnergy(const PerformanceTables &tables, std::size_t event_index, const double &reference_be);
+
+/*!
+ * \brief the adjusted brake energy, cooling time and band of all ten braking events for one reference
+ * brake energy, in eventIndex() order
+ * \details The reference brake energy is bracketed once on the axis shared by the adjusted brake energy
+ * curves, the cooling times and bands follow from the brake category the tables were taken for. Above
+ * the last key, all events are in the warning band, see adjustedBrakeEnergy().
+ */
+EventResults evaluateEvents(const PerformanceTables &tables, const double &reference_be);
+
+/*!
+ * \brief the largest adjusted brake energy with a cooling time of at most minutes, limited to the
+ * caution value. -infinity if even the smallest key needs longer. Assumes the cooling time curve
+ * to be increasing.
+ */
+double adjustedBeForCoolingTime(const PerformanceTables &tables, const double &minutes);
+
+/*!
+ * \brief calculates a landing on in-memory tables, without allocating
+ * \details Gives the same results as the database backed calculation of the application: the
+ * reference brake energy interpolated on the grid plus the taxi distance allowance, the adjusted
+ * brake energy per event and either the cooling time or the caution / warning band.
+ */
+LandingResult evaluateLanding(const PerformanceTables &tables, const LandingInputs &inputs);
+
+/*!
+ * \brief calculates count landings like evaluateLanding(), interpolating the reference brake energies
+ * with interpolateBatch()
+ * \details Gives the same results as evaluateLanding() for every landing. The inputs are converted to
+ * the grid units in blocks on the stack, so nothing is allocated.
+ */
+void evaluateLandings(const PerformanceTables &tables, const LandingInputs *inputs, LandingResult *results, std::size_t count);
+
+/*!
+ * \brief the deviation of calculations on a grid in compact storage from the grid they were converted from
+ */
+struct StorageError
+{
+    double reference_be = 0;        // largest absolute difference of the reference brake energy
+    double cooling_time = 0;        // largest absolute difference in minutes of a cooling time, where both are in the cooling band
+    std::size_t band_changes = 0;   // braking events whose band differs
+    std::size_t evaluations = 0;    // landings compared
+};
+
+/*!
+ * \brief compares the landings calculated on tables.grid with the same landings calculated on compact,
+ * a copy of the grid in another GridStorage
+ * \details The landings are placed on every node of the grid and on the centres between neighbouring
+ * keys. Nodes which are not set in either grid are skipped.
+ */
+StorageError measureStorageError(const PerformanceTables &tables, const ReferenceGrid &compact);
+
+} // namespace BrakeCooling
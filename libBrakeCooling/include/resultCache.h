@@ -0,0 +1,98 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "libBrakeCooling.h"
+
+namespace BrakeCooling {
+
+/*!
+ * \brief the resolution inputs are rounded to before they are used as a cache key
+ * \details The defaults match the resolution of the user interface (1 kt, 1 kg, 1 °C, 1 ft).
+ */
+struct Quantization
+{
+    double speed = 1;
+    double weight = 1;
+    double temp = 1;
+    double alt = 1;
+    double taxi_distance = 1;
+};
+
+/*!
+ * \brief Bounded, thread-safe least recently used cache of landing results
+ * \details Results are keyed on the model, the brake category and the quantized inputs. To make
+ * cached and computed results indistinguishable, results must be computed from quantize()d inputs,
+ * which getOrCompute() takes care of.
+ */
+class ResultCache
+{
+public:
+    explicit ResultCache(std::size_t capacity = 4096, const Quantization &quantization = Quantization());
+
+    LandingInputs quantize(const LandingInputs &inputs) const;
+
+    /*!
+     * \brief looks up a result, returns false on a miss
+     */
+    bool find(const std::string &model, BrakeCategory brake_category, const LandingInputs &inputs, LandingResult &result);
+    void insert(const std::string &model, BrakeCategory brake_category, const LandingInputs &inputs, const LandingResult &result);
+
+    /*!
+     * \brief returns the cached result, or calls compute with the quantized inputs and caches its result
+     */
+    template <typename Compute>
+    LandingResult getOrCompute(const std::string &model, BrakeCategory brake_category, const LandingInputs &inputs, Compute &&compute)
+    {
+        LandingResult result;
+        if (find(model, brake_category, inputs, result))
+            return result;
+        result = compute(quantize(inputs));
+        insert(model, brake_category, inputs, result);
+        return result;
+    }
+
+    /*!
+     * \brief drops all entries. The hit and miss counters are reset as well, unless reset_counters is false.
+     */
+    void clear(bool reset_counters = true);
+    void setCapacity(std::size_t capacity);
+    std::size_t getCapacity() const;
+    std::size_t size() const;
+    std::uint64_t getHits() const {return m_hits;}
+    std::uint64_t getMisses() const {return m_misses;}
+private:
+    struct Key
+    {
+        std::string model;
+        int brake_category;
+        std::int64_t speed;
+        std::int64_t weight;
+        std::int64_t temp;
+        std::int64_t alt;
+        std::int64_t taxi_distance;
+
+        bool operator==(const Key &other) const;
+    };
+    struct KeyHash
+    {
+        std::size_t operator()(const Key &key) const;
+    };
+    using Entry = std::pair<Key, LandingResult>;
+
+    Key makeKey(const std::string &model, BrakeCategory brake_category, const LandingInputs &inputs) const;
+    void evict();
+
+    const Quantization m_quantization;
+    std::size_t m_capacity;
+    mutable std::mutex m_mutex;
+    std::list<Entry> m_entries; // most recently used first
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_index;
+    std::atomic<std::uint64_t> m_hits{0};
+    std::atomic<std::uint64_t> m_misses{0};
+};
+
+} // namespace BrakeCooling
@@ -0,0 +1,95 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace BrakeCooling {
+
+/*!
+ * \brief Holds the current version of an immutable value and replaces it as a whole, read-copy-update style
+ * \details load() hands out the current version, which stays valid for as long as the reader holds the
+ * pointer, no matter how often publish() replaces it in the meantime. Readers do not wait for writers
+ * and never see a partly updated value, as a new version is built completely before it is published.
+ * Writers that derive the new version from the current one have to serialize among themselves.
+ */
+template <typename T>
+class Snapshot
+{
+public:
+    explicit Snapshot(std::shared_ptr<const T> value = std::make_shared<const T>())
+        : m_value(std::move(value))
+    {}
+    Snapshot(const Snapshot &) = delete;
+    Snapshot &operator=(const Snapshot &) = delete;
+
+    std::shared_ptr<const T> load() const
+    {
+        return std::atomic_load_explicit(&m_value, std::memory_order_acquire);
+    }
+
+    /*!
+     * \brief replaces the current version, readers holding the previous one keep it until they let go
+     */
+    void publish(std::shared_ptr<const T> value)
+    {
+        std::atomic_store_explicit(&m_value, std::move(value), std::memory_order_release);
+        m_version.fetch_add(1, std::memory_order_release);
+    }
+
+    /*!
+     * \brief the number of publish() calls, cheap to poll for a new version
+     */
+    std::uint64_t getVersion() const {return m_version.load(std::memory_order_acquire);}
+private:
+    std::shared_ptr<const T> m_value;
+    std::atomic<std::uint64_t> m_version{0};
+};
+
+/*!
+ * \brief Calls a function on a thread of its own whenever one of a set of files changes
+ * \details The files are polled for their size and modification time. A missing file counts as a
+ * state of its own, so creating or deleting one is a change as well. A change is reported once the
+ * files have kept their new state for a full interval, so a file that is still being written is not
+ * read half way. on_change runs on the watcher thread, one call at a time.
+ */
+class FileWatcher
+{
+public:
+    FileWatcher(std::vector<std::string> files, std::chrono::milliseconds interval, std::function<void()> on_change);
+    /*!
+     * \brief stops polling, waits for a running on_change to return
+     */
+    ~FileWatcher();
+    FileWatcher(const FileWatcher &) = delete;
+    FileWatcher &operator=(const FileWatcher &) = delete;
+private:
+    struct FileState
+    {
+        bool exists = false;
+        std::uintmax_t size = 0;
+        std::filesystem::file_time_type modified;
+
+        bool operator==(const FileState &other) const;
+    };
+
+    std::vector<FileState> states() const;
+    void run();
+
+    const std::vector<std::string> m_files;
+    const std::chrono::milliseconds m_interval;
+    const std::function<void()> m_on_change;
+    std::mutex m_mutex;
+    std::condition_variable m_stop_condition;
+    bool m_stop = false;
+    std::thread m_thread;
+};
+
+} // namespace BrakeCooling
@@ -0,0 +1,113 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "libBrakeCooling.h"
+
+namespace BrakeCooling {
+
+/*!
+ * \brief All performance tables of one model
+ * \details Key axes are ascending. The dense tables are laid out as follows:
+ * - reference_be holds the <model>_RAW_BE values, speed varying fastest, then weight, temperature
+ *   and altitude (see ReferenceGrid)
+ * - adjusted_be holds one curve over ref_bes per braking event and reverse thrust setting, in
+ *   eventIndex() order
+ * - cooling_time holds the steel brakes curve over adjusted_steel, followed by the carbon brakes
+ *   curve over adjusted_carbon
+ */
+struct TableData
+{
+    std::vector<double> speeds;
+    std::vector<double> weights;
+    std::vector<double> temps;
+    std::vector<double> alts;
+    std::vector<double> ref_bes;
+    std::vector<double> adjusted_steel;
+    std::vector<double> adjusted_carbon;
+    std::vector<double> reference_be;
+    std::vector<double> adjusted_be;
+    std::vector<double> cooling_time;
+
+    /*!
+     * \brief checks that the table sizes match the axes. Returns false and sets error otherwise.
+     */
+    bool isConsistent(std::string *error = nullptr) const;
+
+    /*!
+     * \brief the number of NaN table values, i.e. entries missing in the source of the tables
+     */
+    std::size_t missingValues() const;
+};
+
+/*!
+ * \brief A compiled table file, mapped into memory and used in place
+ * \details The file starts with a 64 byte header (magic, format version, byte order mark, file size
+ * and a 64-bit FNV-1a checksum of everything after the header), followed by a section table and the
+ * sections. Every section is an array of doubles in host byte order, aligned to 64 bytes. Files of
+ * another version or byte order, or with a wrong size or checksum are rejected.
+ *
+ * Objects handed out by a TableFile (grids and curve pointers) keep or require the mapping alive:
+ * grids hold a reference to the file, raw pointers are valid as long as the TableFile exists.
+ */
+class TableFile : public std::enable_shared_from_this<TableFile>
+{
+public:
+    static constexpr std::uint32_t VERSION = 1;
+
+    enum class Section : std::uint32_t {
+        Speeds = 0, Weights, Temps, Alts, RefBes, AdjustedSteel, AdjustedCarbon,
+        ReferenceBe, AdjustedBe, CoolingTime, Count
+    };
+
+    /*!
+     * \brief writes data to a new file, which replaces file_name once it is complete
+     */
+    static bool write(const std::string &file_name, const TableData &data, std::string *error = nullptr);
+
+    /*!
+     * \brief maps and validates a file. Returns nullptr and sets error on failure.
+     */
+    static std::shared_ptr<const TableFile> open(const std::string &file_name, std::string *error = nullptr);
+
+    TableFile(const TableFile &) = delete;
+    TableFile &operator=(const TableFile &) = delete;
+    ~TableFile();
+
+    const double *getSection(Section section) const {return m_sections[static_cast<std::size_t>(section)].values;}
+    std::size_t getSectionSize(Section section) const {return m_sections[static_cast<std::size_t>(section)].count;}
+    std::uint64_t getChecksum() const {return m_checksum;}
+
+    /*!
+     * \brief the reference brake energy grid, using the mapped values in place
+     */
+    ReferenceGrid getReferenceGrid() const;
+    GridAxis getRefBeAxis() const;
+    GridAxis getAdjustedAxis(BrakeCategory brake_category) const;
+
+    /*!
+     * \brief adjusted brake energies, one per getRefBeAxis() key
+     */
+    const double *getAdjustedBe(BrakingEvent event, bool rev_t) const;
+
+    /*!
+     * \brief cooling times in minutes, one per getAdjustedAxis(brake_category) key
+     */
+    const double *getCoolingTime(BrakeCategory brake_category) const;
+private:
+    TableFile() = default;
+    std::vector<double> getVector(Section section) const;
+
+    struct SectionView
+    {
+        const double *values = nullptr;
+        std::size_t count = 0;
+    };
+
+    const char *m_data = nullptr;
+    std::size_t m_size = 0;
+    std::uint64_t m_checksum = 0;
+    SectionView m_sections[static_cast<std::size_t>(Section::Count)];
+};
+
+} // namespace BrakeCooling
@@ -0,0 +1,106 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace BrakeCooling {
+
+/*!
+ * \brief Lightweight, thread-safe timing and counting of the calculation stages
+ * \details Use the BRAKECOOLING_TRACE_* macros below. Names must be string
+ * literals (or otherwise outlive the trace), as only the pointer is stored. Nothing is recorded until
+ * tracing is enabled with setEnabled(), a disabled scope costs one relaxed atomic load. Defining
+ * BRAKECOOLING_NO_TRACE removes the macros at compile time.
+ *
+ * Every thread records into its own buffer, so recording does not contend. Besides the aggregated
+ * statistics, up to MAX_EVENTS individual scopes are kept per thread for the Chrome trace export.
+ */
+class Trace
+{
+public:
+    /*!
+     * \brief the counter summary() relates all other counters to
+     */
+    static constexpr const char *CALCULATIONS = "calculations";
+    static constexpr std::size_t MAX_EVENTS = 1 << 20;
+
+    static void setEnabled(bool enabled) {s_enabled.store(enabled, std::memory_order_relaxed);}
+    static bool isEnabled() {return s_enabled.load(std::memory_order_relaxed);}
+
+    /*!
+     * \brief nanoseconds on a monotonic clock
+     */
+    static std::int64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static void record(const char *name, std::int64_t start_ns, std::int64_t duration_ns);
+    static void count(const char *name, std::int64_t increment = 1);
+
+    /*!
+     * \brief the sum of a counter over all threads
+     */
+    static std::int64_t getCounter(const std::string &name);
+
+    /*!
+     * \brief all recorded scopes in the Chrome trace event format (chrome://tracing, Perfetto)
+     */
+    static std::string chromeTraceJson();
+
+    /*!
+     * \brief a table of calls, total, mean and maximum time per scope, followed by the counters
+     */
+    static std::string summary();
+
+    static void clear();
+private:
+    static inline std::atomic<bool> s_enabled{false};
+};
+
+/*!
+ * \brief records the time from construction to destruction, if tracing is enabled
+ */
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(const char *name)
+        : m_name(Trace::isEnabled() ? name : nullptr), m_start(m_name ? Trace::now() : 0)
+    {}
+    ~ScopedTimer() {stop();}
+
+    /*!
+     * \brief records the time until now, ending the scope early
+     */
+    void stop()
+    {
+        if (m_name)
+            Trace::record(m_name, m_start, Trace::now() - m_start);
+        m_name = nullptr;
+    }
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+private:
+    const char *m_name;
+    std::int64_t m_start;
+};
+
+} // namespace BrakeCooling
+
+#ifdef BRAKECOOLING_NO_TRACE
+#define BRAKECOOLING_TRACE_SCOPE(name) do {} while (false)
+#define BRAKECOOLING_TRACE_NAMED_SCOPE(variable, name) do {} while (false)
+#define BRAKECOOLING_TRACE_STOP(variable) do {} while (false)
+#define BRAKECOOLING_TRACE_COUNT(name) do {} while (false)
+#else
+#define BRAKECOOLING_TRACE_CONCAT_(a, b) a##b
+#define BRAKECOOLING_TRACE_CONCAT(a, b) BRAKECOOLING_TRACE_CONCAT_(a, b)
+#define BRAKECOOLING_TRACE_SCOPE(name) \
+    const ::BrakeCooling::ScopedTimer BRAKECOOLING_TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#define BRAKECOOLING_TRACE_NAMED_SCOPE(variable, name) ::BrakeCooling::ScopedTimer variable(name)
+#define BRAKECOOLING_TRACE_STOP(variable) variable.stop()
+#define BRAKECOOLING_TRACE_COUNT(name) \
+    do { if (::BrakeCooling::Trace::isEnabled()) ::BrakeCooling::Trace::count(name); } while (false)
+#endif
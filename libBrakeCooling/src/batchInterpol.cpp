@@ -0,0 +1,181 @@
+#include "libBrakeCooling.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#define BRAKECOOLING_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define BRAKECOOLING_TARGET_AVX2
+#else
+#define BRAKECOOLING_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace BrakeCooling {
+
+namespace {
+
+/*
+ * Lane types reduce the 16 gathered corners of Width inputs to one value each, one dimension at a
+ * time like Interpol does. All of them perform the same operations as MultilinearInterpol, in the
+ * same order, so that every lane type yields the same bits as the scalar path.
+ */
+
+struct ScalarLanes
+{
+    static constexpr std::size_t Width = 1;
+
+    static void reduce(double corners[16][Width], const double param[4][Width],
+                       const double low[4][Width], const double high[4][Width], double *ref_be)
+    {
+        std::array<double, 16> values;
+        for (int i = 0; i < 16; i++)
+            values[i] = corners[i][0];
+        ref_be[0] = MultilinearInterpol<4>::interpolate({ Values(low[0][0], high[0][0], param[0][0]),
+                                                          Values(low[1][0], high[1][0], param[1][0]),
+                                                          Values(low[2][0], high[2][0], param[2][0]),
+                                                          Values(low[3][0], high[3][0], param[3][0]) },
+                                                        values);
+    }
+};
+
+#ifdef BRAKECOOLING_X86
+struct Sse2Lanes
+{
+    static constexpr std::size_t Width = 2;
+
+    static __m128d weight(__m128d param, __m128d low, __m128d high)
+    {
+        // 0 for a zero-width dimension, where the division yields NaN
+        return _mm_andnot_pd(_mm_cmpeq_pd(high, low), _mm_div_pd(_mm_sub_pd(param, low), _mm_sub_pd(high, low)));
+    }
+
+    static void reduce(double corners[16][Width], const double param[4][Width],
+                       const double low[4][Width], const double high[4][Width], double *ref_be)
+    {
+        __m128d values[16];
+        for (int i = 0; i < 16; i++)
+            values[i] = _mm_load_pd(corners[i]);
+
+        int n = 16;
+        for (int d = 0; d < 4; d++) {
+            const __m128d t = weight(_mm_load_pd(param[d]), _mm_load_pd(low[d]), _mm_load_pd(high[d]));
+            n /= 2;
+            for (int i = 0; i < n; i++)
+                values[i] = _mm_add_pd(values[2*i], _mm_mul_pd(t, _mm_sub_pd(values[2*i + 1], values[2*i])));
+        }
+        _mm_storeu_pd(ref_be, values[0]);
+    }
+};
+
+struct Avx2Lanes
+{
+    static constexpr std::size_t Width = 4;
+
+    BRAKECOOLING_TARGET_AVX2
+    static __m256d weight(__m256d param, __m256d low, __m256d high)
+    {
+        return _mm256_andnot_pd(_mm256_cmp_pd(high, low, _CMP_EQ_OQ),
+                                _mm256_div_pd(_mm256_sub_pd(param, low), _mm256_sub_pd(high, low)));
+    }
+
+    BRAKECOOLING_TARGET_AVX2
+    static void reduce(double corners[16][Width], const double param[4][Width],
+                       const double low[4][Width], const double high[4][Width], double *ref_be)
+    {
+        __m256d values[16];
+        for (int i = 0; i < 16; i++)
+            values[i] = _mm256_load_pd(corners[i]);
+
+        int n = 16;
+        for (int d = 0; d < 4; d++) {
+            const __m256d t = weight(_mm256_load_pd(param[d]), _mm256_load_pd(low[d]), _mm256_load_pd(high[d]));
+            n /= 2;
+            for (int i = 0; i < n; i++)
+                values[i] = _mm256_add_pd(values[2*i], _mm256_mul_pd(t, _mm256_sub_pd(values[2*i + 1], values[2*i])));
+        }
+        _mm256_storeu_pd(ref_be, values[0]);
+    }
+};
+
+bool cpuSupportsAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    const bool os_saves_ymm = (info[2] & (1 << 27)) && ((_xgetbv(0) & 0x6) == 0x6);
+    __cpuidex(info, 7, 0);
+    return os_saves_ymm && (info[1] & (1 << 5));
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif // BRAKECOOLING_X86
+
+/*!
+ * \brief gathers the corners of Lanes::Width consecutive inputs from the grid and reduces them
+ */
+template <typename Lanes>
+void interpolateBlock(const ReferenceGrid &grid,
+                      const double *speeds, const double *weights, const double *temps, const double *alts,
+                      double *ref_be)
+{
+    constexpr std::size_t W = Lanes::Width;
+    const GridAxis *axes[4] = { &grid.getSpeedAxis(), &grid.getWeightAxis(), &grid.getTempAxis(), &grid.getAltAxis() };
+    const double *inputs[4] = { speeds, weights, temps, alts };
+
+    alignas(32) double corners[16][W];
+    alignas(32) double param[4][W];
+    alignas(32) double low[4][W];
+    alignas(32) double high[4][W];
+
+    for (std::size_t lane = 0; lane < W; lane++) {
+        AxisBracket b[4];
+        for (int d = 0; d < 4; d++) {
+            b[d] = axes[d]->bracket(inputs[d][lane]);
+            param[d][lane] = b[d].parameter;
+            low[d][lane]   = b[d].low_border;
+            high[d][lane]  = b[d].high_border;
+        }
+        for (int i = 0; i < 16; i++)
+            corners[i][lane] = grid.getValue(i & 1        ? b[0].high_index : b[0].low_index,
+                                             i & (1 << 1) ? b[1].high_index : b[1].low_index,
+                                             i & (1 << 2) ? b[2].high_index : b[2].low_index,
+                                             i & (1 << 3) ? b[3].high_index : b[3].low_index);
+    }
+
+    Lanes::reduce(corners, param, low, high, ref_be);
+}
+
+} // namespace
+
+void interpolateBatch(const ReferenceGrid &grid,
+                      const double *speeds,
+                      const double *weights,
+                      const double *temps,
+                      const double *alts,
+                      double *ref_be,
+                      std::size_t count)
+{
+    if (grid.isEmpty()) {
+        std::fill(ref_be, ref_be + count, std::numeric_limits<double>::quiet_NaN());
+        return;
+    }
+
+    std::size_t i = 0;
+#ifdef BRAKECOOLING_X86
+    static const bool use_avx2 = cpuSupportsAvx2();
+    if (use_avx2)
+        for (; i + Avx2Lanes::Width <= count; i += Avx2Lanes::Width)
+            interpolateBlock<Avx2Lanes>(grid, speeds + i, weights + i, temps + i, alts + i, ref_be + i);
+    for (; i + Sse2Lanes::Width <= count; i += Sse2Lanes::Width)
+        interpolateBlock<Sse2Lanes>(grid, speeds + i, weights + i, temps + i, alts + i, ref_be + i);
+#endif
+    for (; i < count; i++)
+        interpolateBlock<ScalarLanes>(grid, speeds + i, weights + i, temps + i, alts + i, ref_be + i);
+}
+
+} // namespace BrakeCooling
@@ -0,0 +1,106 @@
+#include "fleetSimulation.h"
+#include "trace.h"
+#include <thread>
+
+namespace BrakeCooling {
+
+namespace {
+
+/*!
+ * \brief the slope of the cooling time curve in minutes per adjusted brake energy, on the last
+ * segment up to the caution value
+ */
+double coolingSlopeAtCaution(const PerformanceTables &tables)
+{
+    const auto &curve = *tables.cooling_time;
+    const auto bracket = curve.getAxis().bracket(tables.caution_value);
+    const std::size_t high = bracket.parameter == bracket.low_border ? bracket.low_index : bracket.high_index;
+    return high == 0 ? 0 : curve.getSlope(high - 1);
+}
+
+void simulateTailDay(const TailDay &tail_day, std::vector<TurnResult> &turns)
+{
+    if (!tail_day.tables) {
+        for (auto &turn : turns) {
+            turn.in_envelope = false;
+            turn.flagged = true;
+        }
+        return;
+    }
+    const auto &tables = *tail_day.tables;
+    double residual_be = 0;
+    for (std::size_t i = 0; i < tail_day.sectors.size(); i++) {
+        const auto &sector = tail_day.sectors[i];
+        auto &turn = turns[i];
+
+        bool in_envelope = true;
+        const double reference_be = referenceBrakeEnergy(tables, sector.landing, &in_envelope);
+        const double adjusted_be = residual_be + adjustedBrakeEnergy(tables, eventIndex(sector.event, sector.rev_t), reference_be);
+
+        turn.residual_be = residual_be;
+        turn.result = evaluateEvent(tables, adjusted_be);
+        turn.in_envelope = in_envelope;
+        turn.flagged = turn.result.band == CoolingBand::Caution || turn.result.band == CoolingBand::Warning
+                || (turn.result.band == CoolingBand::Cooling && turn.result.cooling_time > sector.ground_time);
+        residual_be = residualBrakeEnergy(tables, adjusted_be, sector.ground_time);
+    }
+}
+
+void simulateTailDays(const std::vector<TailDay> &tail_days, std::size_t first, std::size_t stride,
+                      std::vector<std::vector<TurnResult>> &results)
+{
+    BRAKECOOLING_TRACE_SCOPE("fleet/worker");
+    for (std::size_t i = first; i < tail_days.size(); i += stride)
+        simulateTailDay(tail_days[i], results[i]);
+}
+
+} // namespace
+
+double residualBrakeEnergy(const PerformanceTables &tables, const double &adjusted_be, const double &ground_time)
+{
+    if (!(ground_time > 0))
+        return adjusted_be;
+    const double caution_cooling_time = (*tables.cooling_time)(tables.caution_value);
+    const double slope = coolingSlopeAtCaution(tables);
+
+    double cooling_time;
+    if (adjusted_be > tables.caution_value) {
+        if (!(slope > 0))
+            return adjusted_be; // no rate to cool at
+        cooling_time = caution_cooling_time + (adjusted_be - tables.caution_value) * slope;
+    } else {
+        const auto event = evaluateEvent(tables, adjusted_be);
+        cooling_time = event.band == CoolingBand::Cooling ? event.cooling_time : 0;
+    }
+
+    const double remaining = cooling_time - ground_time;
+    if (remaining <= 0)
+        return 0;
+    if (remaining >= caution_cooling_time && slope > 0)
+        return tables.caution_value + (remaining - caution_cooling_time) / slope;
+    return std::max(0.0, adjustedBeForCoolingTime(tables, remaining));
+}
+
+std::vector<std::vector<TurnResult>> simulateFleet(const std::vector<TailDay> &tail_days, unsigned threads)
+{
+    BRAKECOOLING_TRACE_SCOPE("fleet");
+    // all results are allocated up front, the threads only fill in their own tail days
+    std::vector<std::vector<TurnResult>> results(tail_days.size());
+    for (std::size_t i = 0; i < tail_days.size(); i++)
+        results[i].resize(tail_days[i].sectors.size());
+    if (tail_days.empty())
+        return results;
+
+    std::size_t thread_count = threads > 0 ? threads : std::thread::hardware_concurrency();
+    thread_count = std::clamp<std::size_t>(thread_count, 1, tail_days.size());
+    std::vector<std::thread> workers;
+    workers.reserve(thread_count - 1);
+    for (std::size_t t = 1; t < thread_count; t++)
+        workers.emplace_back(simulateTailDays, std::cref(tail_days), t, thread_count, std::ref(results));
+    simulateTailDays(tail_days, 0, thread_count, results);
+    for (auto &worker : workers)
+        worker.join();
+    return results;
+}
+
+} // namespace BrakeCooling
@@ -0,0 +1,100 @@
+#include "inverseSolver.h"
+
+namespace BrakeCooling {
+
+namespace {
+
+/*!
+ * \brief the largest adjusted brake energy meeting the target. Below the smallest key the cooling
+ * curve is constant, like the table lookup.
+ */
+double adjustedLimit(const PerformanceTables &tables, const InverseProblem &problem)
+{
+    switch (problem.target) {
+    case SolveTarget::NoWarning:
+        return tables.warning_value;
+    case SolveTarget::NoCaution:
+        return tables.caution_value;
+    case SolveTarget::CoolingTime:
+        break;
+    }
+    return adjustedBeForCoolingTime(tables, problem.max_cooling_time);
+}
+
+} // namespace
+
+InverseResults solveInverse(const PerformanceTables &tables, const InverseProblem &problem)
+{
+    InverseResults results;
+    const auto &grid = *tables.grid;
+    const bool by_weight = problem.parameter == SolveParameter::Weight;
+    const GridAxis &axis = by_weight ? grid.getWeightAxis() : grid.getSpeedAxis();
+    const GridAxis &ref_be_axis = tables.adjusted_be[0].getAxis();
+    if (axis.isEmpty() || ref_be_axis.isEmpty())
+        return results;
+
+    // grid units, weight in t and altitude in kft
+    const Params speed(problem.inputs.speed, grid.getSpeedAxis());
+    const Params weight(problem.inputs.weight / 1000, grid.getWeightAxis());
+    const Params temp(problem.inputs.temp, grid.getTempAxis());
+    const Params alt(problem.inputs.alt / 1000, grid.getAltAxis());
+    const auto referenceBe = [&](const double &x) {
+        const Params solved(x, axis);
+        const Interpol interpol = by_weight ? Interpol(speed, solved, temp, alt, grid)
+                                            : Interpol(solved, weight, temp, alt, grid);
+        return interpol.getReferenceBrakingEnergy() + problem.inputs.taxi_distance;
+    };
+
+    // breakpoints: the key values of the solved parameter, and where the reference brake energy
+    // crosses one of its own key values in between
+    std::vector<double> xs;
+    std::vector<double> ref_bes;
+    const auto &ref_be_keys = ref_be_axis.getValues();
+    for (std::size_t i = 0; i < axis.size(); i++) {
+        const double x = axis[i];
+        const double ref_be = referenceBe(x);
+        if (i > 0) {
+            const double x_low = xs.back();
+            const double ref_be_low = ref_bes.back();
+            // keys crossed within the cell, in order of x
+            std::vector<std::pair<double, double>> crossings;
+            for (const double key : ref_be_keys)
+                if ((ref_be_low < key && key < ref_be) || (ref_be < key && key < ref_be_low))
+                    crossings.emplace_back(linearInterpol(key, ref_be_low, x_low, ref_be, x), key);
+            std::sort(crossings.begin(), crossings.end());
+            for (const auto &[crossing_x, key] : crossings) {
+                xs.push_back(crossing_x);
+                ref_bes.push_back(key);
+            }
+        }
+        xs.push_back(x);
+        ref_bes.push_back(ref_be);
+    }
+
+    const double limit = adjustedLimit(tables, problem);
+    const double unit = by_weight ? 1000 : 1;
+    std::vector<double> adjusted(xs.size());
+    for (std::size_t event = 0; event < results.size(); event++) {
+        // +infinity above the last reference brake energy key, so the limit is where the tables end
+        for (std::size_t i = 0; i < xs.size(); i++)
+            adjusted[i] = adjustedBrakeEnergy(tables, event, ref_bes[i]);
+
+        auto &result = results[event];
+        if (!(adjusted[0] <= limit)) {
+            result.status = SolveStatus::Infeasible;
+            continue;
+        }
+        result.status = SolveStatus::Unlimited;
+        result.limit = xs.back() * unit;
+        for (std::size_t i = 0; i + 1 < xs.size(); i++) {
+            if (adjusted[i + 1] > limit) {
+                result.status = SolveStatus::Limited;
+                result.limit = linearInterpol(limit, adjusted[i], xs[i], adjusted[i + 1], xs[i + 1]) * unit;
+                break;
+            }
+        }
+    }
+    return results;
+}
+
+} // namespace BrakeCooling
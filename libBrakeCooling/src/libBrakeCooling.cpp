@@ -2,113 +2,257 @@
 
 namespace BrakeCooling {
 
-Params::Params(const double &parameter_in, const std::vector<double> &table_values)
-    : m_input_parameter(parameter_in)
+GridAxis::GridAxis(const std::vector<double> &values)
+    : m_values(values)
 {
-    if( std::find(table_values.begin(), table_values.end(), parameter_in) != table_values.end()) {
-        // input_parameter is contained in vector
-        m_low_border  = parameter_in;
-        m_high_border = parameter_in;
+    if (m_values.size() < 2)
+        return;
+
+    const double step = m_values[1] - m_values[0];
+    m_uniform = step > 0;
+    for (std::size_t i = 2; m_uniform && i < m_values.size(); i++)
+        m_uniform = std::abs((m_values[i] - m_values[i - 1]) - step) <= 1e-9 * step;
+    if (m_uniform)
+        m_inverse_step = 1 / step;
+}
+
+AxisBracket GridAxis::bracket(const double &parameter_in) const
+{
+    if (m_values.empty()) {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        return {0, 0, nan, nan, nan, AxisStatus::ClampedLow};
+    }
+
+    const std::size_t last = m_values.size() - 1;
+    if (!(parameter_in >= m_values.front()))
+        return {0, 0, m_values.front(), m_values.front(), m_values.front(), AxisStatus::ClampedLow};
+    if (parameter_in > m_values.back())
+        return {last, last, m_values.back(), m_values.back(), m_values.back(), AxisStatus::ClampedHigh};
+
+    // find the first key value that is >= parameter_in
+    std::size_t high;
+    if (m_uniform) {
+        std::size_t i = std::min(static_cast<std::size_t>((parameter_in - m_values.front()) * m_inverse_step), last - 1);
+        // the estimate may be off by one due to rounding
+        while (m_values[i] > parameter_in)
+            i--;
+        while (m_values[i + 1] < parameter_in)
+            i++;
+        high = m_values[i] == parameter_in ? i : i + 1;
     } else {
-        // starting at the second element, find the first element that is >= parameter_in
-        for (int i = 1; table_values.size(); ++i)
-            if (table_values.at(i) >= parameter_in) {
-                m_low_border = table_values.at(i - 1);
-                m_high_border = table_values.at(i);
-                break;
-            }
+        high = static_cast<std::size_t>(std::lower_bound(m_values.begin(), m_values.end(), parameter_in) - m_values.begin());
     }
+
+    if (m_values[high] == parameter_in)
+        return {high, high, parameter_in, parameter_in, parameter_in, AxisStatus::Exact};
+    return {high - 1, high, m_values[high - 1], m_values[high], parameter_in, AxisStatus::Interpolated};
 }
 
-Interpol::Interpol(const Params &speed, 
-             const Params &weight,
-             const Params &temp, 
-             const Params &alt,
-             const std::array<double, 16> &raw_ref_be)
+std::size_t GridAxis::indexOf(const double &value) const
+{
+    std::size_t index;
+    if (m_uniform) {
+        const double position = std::round((value - m_values.front()) * m_inverse_step);
+        if (!(position >= 0 && position < m_values.size()))
+            return m_values.size();
+        index = static_cast<std::size_t>(position);
+    } else {
+        index = static_cast<std::size_t>(std::lower_bound(m_values.begin(), m_values.end(), value - 1e-9) - m_values.begin());
+    }
+
+    if (index == m_values.size() || std::abs(m_values[index] - value) > 1e-9)
+        return m_values.size();
+    return index;
+}
+
+Curve1D::Curve1D(const GridAxis &axis, const double *values)
+    : m_axis(axis)
+    , m_values(values, values + axis.size())
+    , m_slopes(axis.size(), 0)
+{
+    for (std::size_t i = 0; i + 1 < m_values.size(); i++)
+        m_slopes[i] = (m_values[i + 1] - m_values[i]) / (axis[i + 1] - axis[i]);
+}
+
+bool Curve1D::isComplete() const
+{
+    return !m_values.empty() && std::none_of(m_values.begin(), m_values.end(), [](double value) {return std::isnan(value);});
+}
+
+Params::Params(const double &parameter_in, const GridAxis &axis)
+{
+    const AxisBracket bracket = axis.bracket(parameter_in);
+    m_input_parameter = bracket.parameter;
+    m_low_border      = bracket.low_border;
+    m_high_border     = bracket.high_border;
+    m_status          = bracket.status;
+}
+
+Params::Params(const double &parameter_in, const std::vector<double> &table_values)
+    : Params(parameter_in, GridAxis(table_values))
+{}
+
+ReferenceGrid::ReferenceGrid(const std::vector<double> &speeds,
+                             const std::vector<double> &weights,
+                             const std::vector<double> &temps,
+                             const std::vector<double> &alts)
+    : m_speeds(speeds), m_weights(weights), m_temps(temps), m_alts(alts),
+      m_size(speeds.size() * weights.size() * temps.size() * alts.size())
+{
+    auto values = std::make_shared<std::vector<double>>(m_size, std::numeric_limits<double>::quiet_NaN());
+    m_writable_values = values->data();
+    m_values = m_writable_values;
+    m_storage = std::move(values);
+}
+
+ReferenceGrid::ReferenceGrid(const std::vector<double> &speeds,
+                             const std::vector<double> &weights,
+                             const std::vector<double> &temps,
+                             const std::vector<double> &alts,
+                             const double *values,
+                             std::shared_ptr<const void> storage)
+    : m_speeds(speeds), m_weights(weights), m_temps(temps), m_alts(alts),
+      m_storage(std::move(storage)), m_values(values),
+      m_size(speeds.size() * weights.size() * temps.size() * alts.size())
+{}
+
+bool ReferenceGrid::isComplete() const
 {
-    // 1) interpolate with speed parameter
-    std::array<double, 8> speed_corrected_braking_energy;
-    const auto &[ speed_low, speed_high, speed_param ]  = speed.getValues();
-    if (speed_param == speed_low) // no interpolation needed, carry forward every second data point
-        for (int i = 0; i < 8; i++)
-            speed_corrected_braking_energy[i] = raw_ref_be[2*i];
-    else
-        speed_corrected_braking_energy = correctSpeed(raw_ref_be, speed_param, speed_low, speed_high);
-
-    // 2) interpolate with weight parameter
-    std::array<double, 4> weight_corrected_braking_energy;
-    const auto &[ weight_low, weight_high, weight_param ] = weight.getValues();
-    if (weight_param == weight_low)
-        for (int i = 0; i < 4; i++)
-            weight_corrected_braking_energy[i] = speed_corrected_braking_energy[2*i];
-    else
-        weight_corrected_braking_energy = correctWeight(speed_corrected_braking_energy, weight_param, weight_low, weight_high);
-
-    // 3) interpolate with temperature parameter
-    std::array<double, 2> temperature_corrected_braking_energy;
-    const auto &[ temp_low, temp_high, temp_param] = temp.getValues();
-    if (temp_param == temp_low)
-        for (int i = 0; i < 2; i++)
-            temperature_corrected_braking_energy[i] = weight_corrected_braking_energy[i * 2];
-    else
-        temperature_corrected_braking_energy = correctTemperature(weight_corrected_braking_energy, temp_param, temp_low, temp_high);
-
-    // 4) interpolate with altitude parameter
-    const auto &[ alt_low, alt_high, alt_param ] = alt.getValues();
-    if (alt_param == alt_low)
-        m_interpolation = temperature_corrected_braking_energy[0];
-    else
-        m_interpolation = linearInterpol(alt_param,
-                                          alt_low, temperature_corrected_braking_energy[0],
-                                          alt_high, temperature_corrected_braking_energy[1]);
+    if (m_size == 0)
+        return false;
+    if (m_format == GridStorage::Double)
+        return std::none_of(m_values, m_values + m_size, [](double value) { return std::isnan(value); });
+    for (std::size_t i = 0; i < m_size; i++)
+        if (std::isnan(valueAt(i)))
+            return false;
+    return true;
 }
 
-const std::array<double, 8> Interpol::correctSpeed(const std::array<double, 16> &raw_braking_energy,
-                                                  const double &speed_param, const double &speed_low, const double &speed_high) const
+std::size_t ReferenceGrid::getStorageSize() const
 {
-    std::array<double, 8> speed_corrected_braking_energy;
-
-    for (int i = 0; i < 8; i ++) {
-        const double &value_low = raw_braking_energy[i];
-        const double &value_high = raw_braking_energy[i + 1];
-        speed_corrected_braking_energy[i] = linearInterpol(speed_param,
-                                                            speed_low, value_low,
-                                                            speed_high, value_high);
+    switch (m_format) {
+    case GridStorage::Float32: return m_size * sizeof(float);
+    case GridStorage::Fixed16: return m_size * sizeof(std::int16_t);
+    case GridStorage::Fixed32: return m_size * sizeof(std::int32_t);
+    default:                   return m_size * sizeof(double);
+    }
+}
+
+template <typename T>
+void ReferenceGrid::quantize(ReferenceGrid &grid) const
+{
+    double min_value = std::numeric_limits<double>::infinity();
+    double max_value = -std::numeric_limits<double>::infinity();
+    for (std::size_t i = 0; i < m_size; i++) {
+        const double value = valueAt(i);
+        if (!std::isnan(value)) {
+            min_value = std::min(min_value, value);
+            max_value = std::max(max_value, value);
+        }
     }
 
-    return speed_corrected_braking_energy;
+    // symmetric around the centre of the range, min() is left for unset nodes
+    constexpr double STEPS = std::numeric_limits<T>::max();
+    grid.m_fixed_offset = min_value <= max_value ? (min_value + max_value) / 2 : 0;
+    grid.m_fixed_scale  = max_value > min_value ? (max_value - min_value) / (2 * STEPS) : 1;
+
+    auto values = std::make_shared<std::vector<T>>(m_size);
+    for (std::size_t i = 0; i < m_size; i++) {
+        const double value = valueAt(i);
+        (*values)[i] = std::isnan(value)
+                ? std::numeric_limits<T>::min()
+                : static_cast<T>(std::clamp(std::round((value - grid.m_fixed_offset) / grid.m_fixed_scale), -STEPS, STEPS));
+    }
+    grid.m_compact_values = values->data();
+    grid.m_storage = std::move(values);
 }
 
-const std::array<double, 4> Interpol::correctWeight(const std::array<double, 8> &speed_corrected_be,
-                                                   const double &weight_param, const double &weight_low, const double &weight_high) const
+ReferenceGrid ReferenceGrid::withStorage(GridStorage storage) const
 {
-    std::array<double, 4> weight_corrected_brake_energy;
-
-    for (int i = 0; i < 4; i++) {
-        const double &value_low = speed_corrected_be[i];
-        const double &value_high = speed_corrected_be[i+1];
-        weight_corrected_brake_energy[i] = linearInterpol(weight_param,
-                                                           weight_low, value_low,
-                                                           weight_high, value_high);
+    ReferenceGrid grid = *this;
+    grid.m_writable_values = nullptr;
+    grid.m_format = storage;
+    grid.m_values = nullptr;
+    grid.m_compact_values = nullptr;
+    grid.m_fixed_scale = 1;
+    grid.m_fixed_offset = 0;
+
+    switch (storage) {
+    case GridStorage::Double: {
+        auto values = std::make_shared<std::vector<double>>(m_size);
+        for (std::size_t i = 0; i < m_size; i++)
+            (*values)[i] = valueAt(i);
+        grid.m_values = values->data();
+        grid.m_storage = std::move(values);
+        break;
     }
+    case GridStorage::Float32: {
+        auto values = std::make_shared<std::vector<float>>(m_size);
+        for (std::size_t i = 0; i < m_size; i++)
+            (*values)[i] = static_cast<float>(valueAt(i));
+        grid.m_compact_values = values->data();
+        grid.m_storage = std::move(values);
+        break;
+    }
+    case GridStorage::Fixed16:
+        quantize<std::int16_t>(grid);
+        break;
+    case GridStorage::Fixed32:
+        quantize<std::int32_t>(grid);
+        break;
+    }
+    return grid;
+}
 
-    return weight_corrected_brake_energy;
+bool ReferenceGrid::setValue(const double &speed, const double &weight, const double &temp, const double &alt, const double &ref_be)
+{
+    const std::size_t speed_index  = m_speeds.indexOf(speed);
+    const std::size_t weight_index = m_weights.indexOf(weight);
+    const std::size_t temp_index   = m_temps.indexOf(temp);
+    const std::size_t alt_index    = m_alts.indexOf(alt);
+    if (m_writable_values == nullptr || speed_index == m_speeds.size() || weight_index == m_weights.size()
+            || temp_index == m_temps.size() || alt_index == m_alts.size())
+        return false;
+
+    m_writable_values[offset(speed_index, weight_index, temp_index, alt_index)] = ref_be;
+    return true;
 }
 
-const std::array<double, 2> Interpol::correctTemperature(const std::array<double, 4> &weight_corrected_be,
-                                                        const double &temp_param, const double &temp_low, const double &temp_high) const
+std::array<double, 16> ReferenceGrid::getCorners(const Params &speed, const Params &weight, const Params &temp, const Params &alt) const
 {
-    std::array<double, 2> temperature_corrected_brake_energy;
-
-    for (int i = 0; i < 2; i++) {
-        const double &value_low = weight_corrected_be[i];
-        const double &value_high = weight_corrected_be[i+1];
-        temperature_corrected_brake_energy[i] = linearInterpol(temp_param,
-                                                                temp_low, value_low,
-                                                                temp_high, value_high);
+    const std::size_t speed_index[2]  = { m_speeds.indexOf(speed.getLowBorder()),   m_speeds.indexOf(speed.getHighBorder()) };
+    const std::size_t weight_index[2] = { m_weights.indexOf(weight.getLowBorder()), m_weights.indexOf(weight.getHighBorder()) };
+    const std::size_t temp_index[2]   = { m_temps.indexOf(temp.getLowBorder()),     m_temps.indexOf(temp.getHighBorder()) };
+    const std::size_t alt_index[2]    = { m_alts.indexOf(alt.getLowBorder()),       m_alts.indexOf(alt.getHighBorder()) };
+
+    std::array<double, 16> corners;
+    if (isEmpty()) {
+        corners.fill(std::numeric_limits<double>::quiet_NaN());
+        return corners;
     }
+    for (int i = 0; i < 16; i++)
+        corners[i] = getValue(speed_index[i & 1], weight_index[(i >> 1) & 1], temp_index[(i >> 2) & 1], alt_index[(i >> 3) & 1]);
+    return corners;
+}
 
-    return temperature_corrected_brake_energy;
+// the interpolation is evaluated entirely at compile time, for one and for four dimensions
+static_assert(MultilinearInterpol<1>::interpolate({ Values(0, 10, 2.5) }, { 1, 5 }) == 2,
+              "MultilinearInterpol<1> is not a constant expression");
+static_assert(MultilinearInterpol<1>::interpolate({ Values(3, 3, 3) }, { 7, 9 }) == 7,
+              "MultilinearInterpol<1> does not carry the low value of a zero-width dimension");
+// corner i holds its index, which is linear in the corner bits: 0.5 + 2 * 0.5 + 4 * 0.5 + 8 * 0.5
+static_assert(MultilinearInterpol<4>::interpolate({ Values(0, 2, 1), Values(0, 2, 1), Values(0, 2, 1), Values(0, 2, 1) },
+                                                  { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 }) == 7.5,
+              "MultilinearInterpol<4> is not a constant expression");
+
+Interpol::Interpol(const Params &speed, 
+             const Params &weight,
+             const Params &temp, 
+             const Params &alt,
+             const std::array<double, 16> &raw_ref_be)
+{
+    m_interpolation = MultilinearInterpol<4>::interpolate({ speed.getValues(), weight.getValues(), temp.getValues(), alt.getValues() },
+                                                          raw_ref_be);
 }
 
 } // namespace BrakeCooling
\ No newline at end of file
@@ -0,0 +1,194 @@
+#include "monteCarlo.h"
+#include "trace.h"
+#include <random>
+#include <thread>
+
+namespace BrakeCooling {
+
+namespace {
+
+constexpr std::size_t BLOCK_SIZE = 4096;
+constexpr double INF = std::numeric_limits<double>::infinity();
+
+/*!
+ * \brief scrambles the seed of a block, so neighbouring blocks get unrelated generator states
+ */
+std::uint64_t splitMix64(std::uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/*!
+ * \brief draws samples of one input. Holds the distribution state, so there is one per block and input.
+ */
+class Sampler
+{
+public:
+    explicit Sampler(const InputDistribution &distribution)
+        : m_type(distribution.type)
+        , m_normal(distribution.mean, distribution.spread > 0 ? distribution.spread : 1)
+        , m_uniform(distribution.mean - distribution.spread, distribution.mean + distribution.spread)
+        , m_mean(distribution.mean)
+    {
+        if (distribution.spread <= 0)
+            m_type = DistributionType::Fixed;
+    }
+
+    double operator()(std::mt19937_64 &generator)
+    {
+        switch (m_type) {
+        case DistributionType::Normal:
+            return m_normal(generator);
+        case DistributionType::Uniform:
+            return m_uniform(generator);
+        case DistributionType::Fixed:
+            break;
+        }
+        return m_mean;
+    }
+private:
+    DistributionType m_type;
+    std::normal_distribution<double> m_normal;
+    std::uniform_real_distribution<double> m_uniform;
+    double m_mean;
+};
+
+/*!
+ * \brief the outcome of one event as ordered for the percentiles
+ */
+double outcome(const EventResult &event)
+{
+    switch (event.band) {
+    case CoolingBand::NoProcedure:
+        return 0;
+    case CoolingBand::Cooling:
+        return event.cooling_time;
+    case CoolingBand::Caution:
+    case CoolingBand::Warning:
+        break;
+    }
+    return INF;
+}
+
+/*!
+ * \brief the counters of one thread, merged once all threads are done. The counters of neighbouring
+ * threads share cache lines, so a thread counts into a local copy and stores it once at the end.
+ */
+struct ThreadCounts
+{
+    std::array<std::size_t, 10> caution = {};
+    std::array<std::size_t, 10> warning = {};
+    std::size_t out_of_envelope = 0;
+};
+
+/*!
+ * \brief runs the blocks first_block, first_block + stride, ... writing the outcome of sample s of
+ * event i to outcomes[i * samples + s]
+ */
+void runBlocks(const PerformanceTables &tables, const UncertainInputs &inputs, const MonteCarloSettings &settings,
+               std::size_t first_block, std::size_t stride, double *outcomes, ThreadCounts &counts)
+{
+    BRAKECOOLING_TRACE_SCOPE("monte_carlo/worker");
+    ThreadCounts local_counts;
+    const std::size_t samples = settings.samples;
+    const std::size_t blocks = (samples + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    for (std::size_t block = first_block; block < blocks; block += stride) {
+        std::mt19937_64 generator(splitMix64(settings.seed ^ splitMix64(block)));
+        Sampler speed(inputs.speed);
+        Sampler weight(inputs.weight);
+        Sampler temp(inputs.temp);
+        Sampler alt(inputs.alt);
+        Sampler taxi_distance(inputs.taxi_distance);
+
+        const std::size_t end = std::min(samples, (block + 1) * BLOCK_SIZE);
+        for (std::size_t s = block * BLOCK_SIZE; s < end; s++) {
+            LandingInputs sample;
+            sample.speed = speed(generator);
+            sample.weight = weight(generator);
+            sample.temp = temp(generator);
+            sample.alt = alt(generator);
+            sample.taxi_distance = std::max(0.0, taxi_distance(generator));
+
+            const LandingResult result = evaluateLanding(tables, sample);
+            local_counts.out_of_envelope += !result.in_envelope;
+            for (std::size_t i = 0; i < result.events.size(); i++) {
+                const auto &event = result.events[i];
+                local_counts.caution[i] += event.band == CoolingBand::Caution;
+                local_counts.warning[i] += event.band == CoolingBand::Warning;
+                outcomes[i * samples + s] = outcome(event);
+            }
+        }
+    }
+    counts = local_counts;
+}
+
+/*!
+ * \brief nearest rank percentile, partially reordering values
+ */
+double percentile(double *begin, double *end, double p)
+{
+    const auto n = static_cast<std::size_t>(end - begin);
+    const auto rank = static_cast<std::size_t>(std::ceil(p * n));
+    double *nth = begin + (rank > 0 ? rank - 1 : 0);
+    std::nth_element(begin, nth, end);
+    return *nth;
+}
+
+} // namespace
+
+MonteCarloResult runMonteCarlo(const PerformanceTables &tables,
+                               const UncertainInputs &inputs,
+                               const MonteCarloSettings &settings)
+{
+    BRAKECOOLING_TRACE_SCOPE("monte_carlo");
+    MonteCarloResult result;
+    const std::size_t samples = settings.samples;
+    if (samples == 0)
+        return result;
+
+    const std::size_t blocks = (samples + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    std::size_t threads = settings.threads > 0 ? settings.threads : std::thread::hardware_concurrency();
+    threads = std::clamp<std::size_t>(threads, 1, blocks);
+
+    // everything the workers write to is allocated up front
+    std::vector<double> outcomes(result.events.size() * samples);
+    std::vector<ThreadCounts> counts(threads);
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (std::size_t t = 1; t < threads; t++)
+        workers.emplace_back(runBlocks, std::cref(tables), std::cref(inputs), std::cref(settings),
+                             t, threads, outcomes.data(), std::ref(counts[t]));
+    runBlocks(tables, inputs, settings, 0, threads, outcomes.data(), counts[0]);
+    for (auto &worker : workers)
+        worker.join();
+
+    BRAKECOOLING_TRACE_SCOPE("monte_carlo/statistics");
+    std::size_t out_of_envelope = 0;
+    for (const auto &thread_counts : counts)
+        out_of_envelope += thread_counts.out_of_envelope;
+    result.samples = samples;
+    result.out_of_envelope_probability = double(out_of_envelope) / samples;
+    for (std::size_t i = 0; i < result.events.size(); i++) {
+        auto &event = result.events[i];
+        std::size_t caution = 0;
+        std::size_t warning = 0;
+        for (const auto &thread_counts : counts) {
+            caution += thread_counts.caution[i];
+            warning += thread_counts.warning[i];
+        }
+        event.caution_probability = double(caution) / samples;
+        event.warning_probability = double(warning) / samples;
+
+        double *begin = outcomes.data() + i * samples;
+        double *end = begin + samples;
+        event.p50 = percentile(begin, end, 0.5);
+        event.p90 = percentile(begin, end, 0.9);
+        event.p99 = percentile(begin, end, 0.99);
+    }
+    return result;
+}
+
+} // namespace BrakeCooling
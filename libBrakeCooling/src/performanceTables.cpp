@@ -0,0 +1,171 @@
+#include "performanceTables.h"
+
+namespace BrakeCooling {
+
+namespace {
+
+/*!
+ * \brief the keys of an axis and the centres between them
+ */
+std::vector<double> samplePoints(const GridAxis &axis)
+{
+    std::vector<double> points;
+    for (std::size_t i = 0; i < axis.size(); i++) {
+        if (i > 0)
+            points.push_back((axis[i - 1] + axis[i]) / 2);
+        points.push_back(axis[i]);
+    }
+    return points;
+}
+
+} // namespace
+
+double referenceBrakeEnergy(const PerformanceTables &tables, const LandingInputs &inputs, bool *in_envelope)
+{
+    const auto &grid = *tables.grid;
+    const Params speed(inputs.speed, grid.getSpeedAxis());
+    const Params weight(inputs.weight / 1000, grid.getWeightAxis());
+    const Params temp(inputs.temp, grid.getTempAxis());
+    const Params alt(inputs.alt / 1000, grid.getAltAxis());
+    if (in_envelope)
+        *in_envelope = !(speed.isOutOfEnvelope() || weight.isOutOfEnvelope()
+                         || temp.isOutOfEnvelope() || alt.isOutOfEnvelope());
+    return Interpol(speed, weight, temp, alt, grid).getReferenceBrakingEnergy() + inputs.taxi_distance;
+}
+
+LandingResult evaluateLanding(const PerformanceTables &tables, const LandingInputs &inputs)
+{
+    LandingResult result;
+    result.reference_be = referenceBrakeEnergy(tables, inputs, &result.in_envelope);
+    result.events = evaluateEvents(tables, result.reference_be);
+    return result;
+}
+
+double adjustedBrakeEnergy(const PerformanceTables &tables, std::size_t event_index, const double &reference_be)
+{
+    const auto &curve = tables.adjusted_be[event_index];
+    const auto bracket = curve.getAxis().bracket(reference_be);
+    if (bracket.status == AxisStatus::ClampedHigh)
+        return std::numeric_limits<double>::infinity();
+    return curve.evaluate(bracket);
+}
+
+EventResults evaluateEvents(const PerformanceTables &tables, const double &reference_be)
+{
+    // all curves share the reference brake energy axis
+    const auto bracket = tables.adjusted_be[0].getAxis().bracket(reference_be);
+    EventResults results;
+    if (bracket.status == AxisStatus::ClampedHigh) {
+        results.fill(evaluateEvent(tables, std::numeric_limits<double>::infinity()));
+        return results;
+    }
+    for (std::size_t i = 0; i < results.size(); i++)
+        results[i] = evaluateEvent(tables, tables.adjusted_be[i].evaluate(bracket));
+    return results;
+}
+
+void evaluateLandings(const PerformanceTables &tables, const LandingInputs *inputs, LandingResult *results, std::size_t count)
+{
+    constexpr std::size_t BLOCK = 256;
+    const auto &grid = *tables.grid;
+    const auto in_range = [](const GridAxis &axis, double value) {
+        return !axis.isEmpty() && value >= axis[0] && value <= axis[axis.size() - 1];
+    };
+
+    double speeds[BLOCK], weights[BLOCK], temps[BLOCK], alts[BLOCK], ref_be[BLOCK];
+    for (std::size_t begin = 0; begin < count; begin += BLOCK) {
+        const std::size_t n = std::min(BLOCK, count - begin);
+        for (std::size_t i = 0; i < n; i++) {
+            const auto &landing = inputs[begin + i];
+            speeds[i]  = landing.speed;
+            weights[i] = landing.weight / 1000;
+            temps[i]   = landing.temp;
+            alts[i]    = landing.alt / 1000;
+        }
+        interpolateBatch(grid, speeds, weights, temps, alts, ref_be, n);
+
+        for (std::size_t i = 0; i < n; i++) {
+            auto &result = results[begin + i];
+            result.reference_be = ref_be[i] + inputs[begin + i].taxi_distance;
+            result.in_envelope = in_range(grid.getSpeedAxis(), speeds[i]) && in_range(grid.getWeightAxis(), weights[i])
+                    && in_range(grid.getTempAxis(), temps[i]) && in_range(grid.getAltAxis(), alts[i]);
+            result.events = evaluateEvents(tables, result.reference_be);
+        }
+    }
+}
+
+EventResult evaluateEvent(const PerformanceTables &tables, const double &adjusted_be)
+{
+    EventResult event;
+    event.adjusted_be = adjusted_be;
+    if (adjusted_be > tables.warning_value) {
+        event.band = CoolingBand::Warning;
+    } else if (adjusted_be > tables.caution_value) {
+        event.band = CoolingBand::Caution;
+    } else {
+        // below the first non-zero key no special procedure is required
+        const auto &curve = *tables.cooling_time;
+        const auto bracket = curve.getAxis().bracket(adjusted_be);
+        event.cooling_time = bracket.high_border == 0 ? -1 : curve.evaluate(bracket);
+        event.band = event.cooling_time > 0 ? CoolingBand::Cooling : CoolingBand::NoProcedure;
+    }
+    return event;
+}
+
+double adjustedBeForCoolingTime(const PerformanceTables &tables, const double &minutes)
+{
+    const auto &axis = tables.cooling_time->getAxis();
+    const auto &cooling = tables.cooling_time->getValues();
+    if (axis.isEmpty() || cooling[0] > minutes)
+        return -std::numeric_limits<double>::infinity();
+    double limit = std::numeric_limits<double>::infinity();
+    for (std::size_t i = 0; i + 1 < axis.size(); i++) {
+        if (cooling[i + 1] > minutes) {
+            limit = linearInterpol(minutes, cooling[i], axis[i], cooling[i + 1], axis[i + 1]);
+            break;
+        }
+    }
+    // above the caution value there is no cooling time, but a special procedure
+    return std::min(limit, tables.caution_value);
+}
+
+StorageError measureStorageError(const PerformanceTables &tables, const ReferenceGrid &compact)
+{
+    StorageError error;
+    const auto &grid = *tables.grid;
+    const auto speeds  = samplePoints(grid.getSpeedAxis());
+    const auto weights = samplePoints(grid.getWeightAxis());
+    const auto temps   = samplePoints(grid.getTempAxis());
+    const auto alts    = samplePoints(grid.getAltAxis());
+
+    for (const double alt_value : alts) {
+        const Params alt(alt_value, grid.getAltAxis());
+        for (const double temp_value : temps) {
+            const Params temp(temp_value, grid.getTempAxis());
+            for (const double weight_value : weights) {
+                const Params weight(weight_value, grid.getWeightAxis());
+                for (const double speed_value : speeds) {
+                    const Params speed(speed_value, grid.getSpeedAxis());
+                    const double exact_be   = Interpol(speed, weight, temp, alt, grid).getReferenceBrakingEnergy();
+                    const double compact_be = Interpol(speed, weight, temp, alt, compact).getReferenceBrakingEnergy();
+                    if (std::isnan(exact_be) || std::isnan(compact_be))
+                        continue;
+                    error.evaluations++;
+                    error.reference_be = std::max(error.reference_be, std::abs(exact_be - compact_be));
+
+                    const auto exact  = evaluateEvents(tables, exact_be);
+                    const auto approx = evaluateEvents(tables, compact_be);
+                    for (std::size_t i = 0; i < exact.size(); i++) {
+                        if (exact[i].band != approx[i].band)
+                            error.band_changes++;
+                        else if (exact[i].band == CoolingBand::Cooling)
+                            error.cooling_time = std::max(error.cooling_time, std::abs(exact[i].cooling_time - approx[i].cooling_time));
+                    }
+                }
+            }
+        }
+    }
+    return error;
+}
+
+} // namespace BrakeCooling
@@ -0,0 +1,133 @@
+#include "resultCache.h"
+
+namespace BrakeCooling {
+
+namespace {
+
+std::int64_t steps(const double &value, const double &step)
+{
+    return std::llround(value / step);
+}
+
+} // namespace
+
+ResultCache::ResultCache(std::size_t capacity, const Quantization &quantization)
+    : m_quantization(quantization), m_capacity(capacity)
+{}
+
+LandingInputs ResultCache::quantize(const LandingInputs &inputs) const
+{
+    LandingInputs quantized;
+    quantized.speed         = steps(inputs.speed, m_quantization.speed) * m_quantization.speed;
+    quantized.weight        = steps(inputs.weight, m_quantization.weight) * m_quantization.weight;
+    quantized.temp          = steps(inputs.temp, m_quantization.temp) * m_quantization.temp;
+    quantized.alt           = steps(inputs.alt, m_quantization.alt) * m_quantization.alt;
+    quantized.taxi_distance = steps(inputs.taxi_distance, m_quantization.taxi_distance) * m_quantization.taxi_distance;
+    return quantized;
+}
+
+bool ResultCache::find(const std::string &model, BrakeCategory brake_category, const LandingInputs &inputs, LandingResult &result)
+{
+    const Key key = makeKey(model, brake_category, inputs);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_index.find(key);
+    if (it == m_index.end()) {
+        m_misses++;
+        return false;
+    }
+    // move to the front of the usage list
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    result = it->second->second;
+    m_hits++;
+    return true;
+}
+
+void ResultCache::insert(const std::string &model, BrakeCategory brake_category, const LandingInputs &inputs, const LandingResult &result)
+{
+    Key key = makeKey(model, brake_category, inputs);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        it->second->second = result;
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return;
+    }
+    if (m_capacity == 0)
+        return;
+
+    m_entries.emplace_front(std::move(key), result);
+    m_index.emplace(m_entries.front().first, m_entries.begin());
+    evict();
+}
+
+void ResultCache::clear(bool reset_counters)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_index.clear();
+    if (reset_counters) {
+        m_hits = 0;
+        m_misses = 0;
+    }
+}
+
+void ResultCache::setCapacity(std::size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_capacity = capacity;
+    evict();
+}
+
+std::size_t ResultCache::getCapacity() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_capacity;
+}
+
+std::size_t ResultCache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+/*!
+ * \brief drops the least recently used entries exceeding the capacity. Expects m_mutex to be held.
+ */
+void ResultCache::evict()
+{
+    while (m_entries.size() > m_capacity) {
+        m_index.erase(m_entries.back().first);
+        m_entries.pop_back();
+    }
+}
+
+ResultCache::Key ResultCache::makeKey(const std::string &model, BrakeCategory brake_category, const LandingInputs &inputs) const
+{
+    return Key{model,
+               static_cast<int>(brake_category),
+               steps(inputs.speed, m_quantization.speed),
+               steps(inputs.weight, m_quantization.weight),
+               steps(inputs.temp, m_quantization.temp),
+               steps(inputs.alt, m_quantization.alt),
+               steps(inputs.taxi_distance, m_quantization.taxi_distance)};
+}
+
+bool ResultCache::Key::operator==(const Key &other) const
+{
+    return brake_category == other.brake_category
+            && speed == other.speed && weight == other.weight && temp == other.temp && alt == other.alt
+            && taxi_distance == other.taxi_distance && model == other.model;
+}
+
+std::size_t ResultCache::KeyHash::operator()(const Key &key) const
+{
+    // boost::hash_combine
+    std::size_t seed = std::hash<std::string>()(key.model);
+    for (const std::int64_t value : {std::int64_t(key.brake_category), key.speed, key.weight, key.temp, key.alt, key.taxi_distance})
+        seed ^= std::hash<std::int64_t>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    return seed;
+}
+
+} // namespace BrakeCooling
@@ -0,0 +1,61 @@
+#include "snapshot.h"
+
+namespace BrakeCooling {
+
+bool FileWatcher::FileState::operator==(const FileState &other) const
+{
+    return exists == other.exists && size == other.size && modified == other.modified;
+}
+
+FileWatcher::FileWatcher(std::vector<std::string> files, std::chrono::milliseconds interval, std::function<void()> on_change)
+    : m_files(std::move(files)), m_interval(interval), m_on_change(std::move(on_change))
+{
+    // started last, run() uses all other members
+    m_thread = std::thread(&FileWatcher::run, this);
+}
+
+FileWatcher::~FileWatcher()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_stop_condition.notify_all();
+    m_thread.join();
+}
+
+std::vector<FileWatcher::FileState> FileWatcher::states() const
+{
+    std::vector<FileState> states(m_files.size());
+    for (std::size_t i = 0; i < m_files.size(); i++) {
+        // the error_code overloads, a file may disappear between the calls
+        std::error_code error;
+        const std::filesystem::path path(m_files[i]);
+        states[i].modified = std::filesystem::last_write_time(path, error);
+        if (error)
+            continue;
+        states[i].size = std::filesystem::file_size(path, error);
+        states[i].exists = !error;
+    }
+    return states;
+}
+
+void FileWatcher::run()
+{
+    std::vector<FileState> reported = states();
+    std::vector<FileState> previous = reported;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop_condition.wait_for(lock, m_interval, [this] {return m_stop;})) {
+        lock.unlock();
+        const std::vector<FileState> current = states();
+        // unchanged since the last poll but different from the last report: the writer is done
+        if (current == previous && current != reported) {
+            reported = current;
+            m_on_change();
+        }
+        previous = current;
+        lock.lock();
+    }
+}
+
+} // namespace BrakeCooling
@@ -0,0 +1,287 @@
+#include "tableFile.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace BrakeCooling {
+
+namespace {
+
+constexpr char MAGIC[8] = {'Q', 'B', 'C', 'T', 'A', 'B', 'L', 'E'};
+constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+constexpr std::size_t ALIGNMENT = 64;
+constexpr std::size_t SECTION_COUNT = static_cast<std::size_t>(TableFile::Section::Count);
+
+struct FileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t file_size;
+    std::uint64_t checksum;
+    std::uint32_t section_count;
+    std::uint32_t reserved[7];
+};
+static_assert(sizeof(FileHeader) == 64, "unexpected padding in FileHeader");
+
+struct SectionEntry
+{
+    std::uint64_t offset;
+    std::uint64_t count;
+};
+static_assert(sizeof(SectionEntry) == 16, "unexpected padding in SectionEntry");
+
+constexpr std::size_t HEADER_SIZE = sizeof(FileHeader);
+
+std::size_t align(std::size_t offset)
+{
+    return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+std::uint64_t fnv1a(const char *data, std::size_t size)
+{
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (std::size_t i = 0; i < size; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+bool fail(std::string *error, const std::string &message)
+{
+    if (error)
+        *error = message;
+    return false;
+}
+
+} // namespace
+
+bool TableData::isConsistent(std::string *error) const
+{
+    for (const auto *axis : {&speeds, &weights, &temps, &alts, &ref_bes, &adjusted_steel, &adjusted_carbon}) {
+        if (axis->empty())
+            return fail(error, "empty key axis");
+        if (!std::is_sorted(axis->begin(), axis->end()))
+            return fail(error, "key axis not ascending");
+    }
+    if (reference_be.size() != speeds.size() * weights.size() * temps.size() * alts.size())
+        return fail(error, "reference brake energy table does not match the key axes");
+    if (adjusted_be.size() != 10 * ref_bes.size())
+        return fail(error, "adjusted brake energy table does not match the reference brake energy axis");
+    if (cooling_time.size() != adjusted_steel.size() + adjusted_carbon.size())
+        return fail(error, "cooling time table does not match the adjusted brake energy axes");
+    return true;
+}
+
+std::size_t TableData::missingValues() const
+{
+    std::size_t missing = 0;
+    for (const auto *table : {&reference_be, &adjusted_be, &cooling_time})
+        for (const double value : *table)
+            if (std::isnan(value))
+                missing++;
+    return missing;
+}
+
+bool TableFile::write(const std::string &file_name, const TableData &data, std::string *error)
+{
+    if (!data.isConsistent(error))
+        return false;
+
+    const std::vector<double>* sections[SECTION_COUNT] = {
+        &data.speeds, &data.weights, &data.temps, &data.alts, &data.ref_bes, &data.adjusted_steel,
+        &data.adjusted_carbon, &data.reference_be, &data.adjusted_be, &data.cooling_time
+    };
+
+    // lay out the file in memory, then checksum and write it in one go
+    SectionEntry entries[SECTION_COUNT];
+    std::size_t offset = align(HEADER_SIZE + sizeof(entries));
+    for (std::size_t i = 0; i < SECTION_COUNT; i++) {
+        entries[i].offset = offset;
+        entries[i].count = sections[i]->size();
+        offset = align(offset + sections[i]->size() * sizeof(double));
+    }
+
+    std::vector<char> buffer(offset, 0);
+    std::memcpy(buffer.data() + HEADER_SIZE, entries, sizeof(entries));
+    for (std::size_t i = 0; i < SECTION_COUNT; i++)
+        std::memcpy(buffer.data() + entries[i].offset, sections[i]->data(), sections[i]->size() * sizeof(double));
+
+    FileHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.file_size = buffer.size();
+    header.checksum = fnv1a(buffer.data() + HEADER_SIZE, buffer.size() - HEADER_SIZE);
+    header.section_count = SECTION_COUNT;
+    std::memcpy(buffer.data(), &header, sizeof(header));
+
+    const std::string temp_name = file_name + ".tmp";
+    {
+        std::ofstream out(temp_name, std::ios::binary | std::ios::trunc);
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        if (!out)
+            return fail(error, "unable to write " + temp_name);
+    }
+#ifdef _WIN32
+    std::remove(file_name.c_str());
+#endif
+    if (std::rename(temp_name.c_str(), file_name.c_str()) != 0) {
+        std::remove(temp_name.c_str());
+        return fail(error, "unable to replace " + file_name);
+    }
+    return true;
+}
+
+std::shared_ptr<const TableFile> TableFile::open(const std::string &file_name, std::string *error)
+{
+    std::shared_ptr<TableFile> file(new TableFile);
+
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        fail(error, "unable to open " + file_name);
+        return nullptr;
+    }
+    LARGE_INTEGER size;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(handle, &size) && size.QuadPart > 0)
+        mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(handle);
+    if (mapping == nullptr) {
+        fail(error, "unable to map " + file_name);
+        return nullptr;
+    }
+    file->m_data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    CloseHandle(mapping);
+    if (file->m_data == nullptr) {
+        fail(error, "unable to map " + file_name);
+        return nullptr;
+    }
+    file->m_size = static_cast<std::size_t>(size.QuadPart);
+#else
+    const int fd = ::open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+        fail(error, "unable to open " + file_name);
+        return nullptr;
+    }
+    struct stat status;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &status) == 0 && status.st_size > 0)
+        data = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        fail(error, "unable to map " + file_name);
+        return nullptr;
+    }
+    file->m_data = static_cast<const char*>(data);
+    file->m_size = static_cast<std::size_t>(status.st_size);
+#endif
+
+    // validate the header before trusting any offset
+    FileHeader header;
+    if (file->m_size < HEADER_SIZE + SECTION_COUNT * sizeof(SectionEntry)) {
+        fail(error, file_name + " is too small");
+        return nullptr;
+    }
+    std::memcpy(&header, file->m_data, sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        fail(error, file_name + " is not a table file");
+        return nullptr;
+    }
+    if (header.version != VERSION || header.byte_order != BYTE_ORDER_MARK || header.section_count != SECTION_COUNT) {
+        fail(error, file_name + " has an unsupported version or byte order");
+        return nullptr;
+    }
+    if (header.file_size != file->m_size) {
+        fail(error, file_name + " is truncated");
+        return nullptr;
+    }
+    if (fnv1a(file->m_data + HEADER_SIZE, file->m_size - HEADER_SIZE) != header.checksum) {
+        fail(error, file_name + " is corrupt (checksum mismatch)");
+        return nullptr;
+    }
+    file->m_checksum = header.checksum;
+
+    const auto *entries = reinterpret_cast<const SectionEntry*>(file->m_data + HEADER_SIZE);
+    for (std::size_t i = 0; i < SECTION_COUNT; i++) {
+        if (entries[i].offset % ALIGNMENT != 0 || entries[i].offset > file->m_size
+                || entries[i].count > (file->m_size - entries[i].offset) / sizeof(double)) {
+            fail(error, file_name + " has an invalid section table");
+            return nullptr;
+        }
+        file->m_sections[i].values = reinterpret_cast<const double*>(file->m_data + entries[i].offset);
+        file->m_sections[i].count = static_cast<std::size_t>(entries[i].count);
+    }
+
+    const auto size = [&file](Section section) { return file->getSectionSize(section); };
+    if (size(Section::ReferenceBe) != size(Section::Speeds) * size(Section::Weights) * size(Section::Temps) * size(Section::Alts)
+            || size(Section::AdjustedBe) != 10 * size(Section::RefBes)
+            || size(Section::CoolingTime) != size(Section::AdjustedSteel) + size(Section::AdjustedCarbon)) {
+        fail(error, file_name + " has inconsistent table sizes");
+        return nullptr;
+    }
+    return file;
+}
+
+TableFile::~TableFile()
+{
+    if (m_data == nullptr)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+#else
+    munmap(const_cast<char*>(m_data), m_size);
+#endif
+}
+
+ReferenceGrid TableFile::getReferenceGrid() const
+{
+    return ReferenceGrid(getVector(Section::Speeds), getVector(Section::Weights),
+                         getVector(Section::Temps), getVector(Section::Alts),
+                         getSection(Section::ReferenceBe), shared_from_this());
+}
+
+GridAxis TableFile::getRefBeAxis() const
+{
+    return GridAxis(getVector(Section::RefBes));
+}
+
+GridAxis TableFile::getAdjustedAxis(BrakeCategory brake_category) const
+{
+    return GridAxis(getVector(brake_category == BrakeCategory::Steel ? Section::AdjustedSteel : Section::AdjustedCarbon));
+}
+
+const double *TableFile::getAdjustedBe(BrakingEvent event, bool rev_t) const
+{
+    return getSection(Section::AdjustedBe) + eventIndex(event, rev_t) * getSectionSize(Section::RefBes);
+}
+
+const double *TableFile::getCoolingTime(BrakeCategory brake_category) const
+{
+    const double *cooling_time = getSection(Section::CoolingTime);
+    return brake_category == BrakeCategory::Steel ? cooling_time : cooling_time + getSectionSize(Section::AdjustedSteel);
+}
+
+/*!
+ * \brief copies a (small) key axis section, GridAxis owns its values
+ */
+std::vector<double> TableFile::getVector(Section section) const
+{
+    return std::vector<double>(getSection(section), getSection(section) + getSectionSize(section));
+}
+
+} // namespace BrakeCooling
@@ -0,0 +1,192 @@
+#include "trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace BrakeCooling {
+
+namespace {
+
+struct TraceEvent
+{
+    const char *name;
+    std::int64_t start_ns;
+    std::int64_t duration_ns;
+};
+
+struct Statistics
+{
+    std::int64_t calls = 0;
+    std::int64_t total_ns = 0;
+    std::int64_t max_ns = 0;
+};
+
+/*!
+ * \brief the records of one thread. The mutex is only contended while exporting.
+ */
+struct ThreadBuffer
+{
+    std::mutex mutex;
+    std::uint32_t thread_id = 0;
+    std::vector<TraceEvent> events;
+    std::unordered_map<const char*, Statistics> statistics;
+    std::unordered_map<const char*, std::int64_t> counters;
+};
+
+/*!
+ * \brief all thread buffers. Buffers outlive their threads, so nothing recorded gets lost.
+ */
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+};
+
+Registry &registry()
+{
+    static Registry registry;
+    return registry;
+}
+
+ThreadBuffer &threadBuffer()
+{
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        buffer = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        buffer->thread_id = static_cast<std::uint32_t>(registry().buffers.size() + 1);
+        registry().buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+/*!
+ * \brief calls function(buffer) for every thread buffer, with the buffer locked
+ */
+template <typename Function>
+void forEachBuffer(Function &&function)
+{
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    for (const auto &buffer : registry().buffers) {
+        std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+        function(*buffer);
+    }
+}
+
+void appendEscaped(std::string &out, const char *text)
+{
+    for (; *text; text++) {
+        if (*text == '"' || *text == '\\')
+            out += '\\';
+        out += *text;
+    }
+}
+
+} // namespace
+
+void Trace::record(const char *name, std::int64_t start_ns, std::int64_t duration_ns)
+{
+    auto &buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    auto &statistics = buffer.statistics[name];
+    statistics.calls++;
+    statistics.total_ns += duration_ns;
+    statistics.max_ns = std::max(statistics.max_ns, duration_ns);
+    if (buffer.events.size() < MAX_EVENTS)
+        buffer.events.push_back({name, start_ns, duration_ns});
+}
+
+void Trace::count(const char *name, std::int64_t increment)
+{
+    auto &buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.counters[name] += increment;
+}
+
+std::int64_t Trace::getCounter(const std::string &name)
+{
+    std::int64_t total = 0;
+    forEachBuffer([&](const ThreadBuffer &buffer) {
+        for (const auto &[counter, value] : buffer.counters)
+            if (name == counter)
+                total += value;
+    });
+    return total;
+}
+
+std::string Trace::chromeTraceJson()
+{
+    std::string out = "{\"traceEvents\":[";
+    bool first = true;
+    char number[96];
+    forEachBuffer([&](const ThreadBuffer &buffer) {
+        for (const auto &event : buffer.events) {
+            out += first ? "\n" : ",\n";
+            first = false;
+            out += "{\"name\":\"";
+            appendEscaped(out, event.name);
+            std::snprintf(number, sizeof(number), "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                          event.start_ns / 1e3, event.duration_ns / 1e3, buffer.thread_id);
+            out += number;
+        }
+    });
+    out += "\n],\"displayTimeUnit\":\"ns\"}\n";
+    return out;
+}
+
+std::string Trace::summary()
+{
+    // merged by name, the same name may have a different address in every translation unit
+    std::map<std::string, Statistics> statistics;
+    std::map<std::string, std::int64_t> counters;
+    forEachBuffer([&](const ThreadBuffer &buffer) {
+        for (const auto &[name, value] : buffer.statistics) {
+            auto &merged = statistics[name];
+            merged.calls += value.calls;
+            merged.total_ns += value.total_ns;
+            merged.max_ns = std::max(merged.max_ns, value.max_ns);
+        }
+        for (const auto &[name, value] : buffer.counters)
+            counters[name] += value;
+    });
+
+    std::string out;
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-32s %12s %12s %12s %12s\n", "scope", "calls", "total ms", "mean us", "max us");
+    out += line;
+    for (const auto &[name, value] : statistics) {
+        std::snprintf(line, sizeof(line), "%-32s %12lld %12.3f %12.3f %12.3f\n", name.c_str(),
+                      static_cast<long long>(value.calls), value.total_ns / 1e6,
+                      value.total_ns / 1e3 / value.calls, value.max_ns / 1e3);
+        out += line;
+    }
+
+    const auto calculations = counters.find(CALCULATIONS);
+    const bool per_calculation = calculations != counters.end() && calculations->second > 0;
+    std::snprintf(line, sizeof(line), "\n%-32s %12s %12s\n", "counter", "total", per_calculation ? "per calc." : "");
+    out += line;
+    for (const auto &[name, value] : counters) {
+        if (per_calculation)
+            std::snprintf(line, sizeof(line), "%-32s %12lld %12.2f\n", name.c_str(), static_cast<long long>(value),
+                          double(value) / calculations->second);
+        else
+            std::snprintf(line, sizeof(line), "%-32s %12lld\n", name.c_str(), static_cast<long long>(value));
+        out += line;
+    }
+    return out;
+}
+
+void Trace::clear()
+{
+    forEachBuffer([](ThreadBuffer &buffer) {
+        buffer.events.clear();
+        buffer.statistics.clear();
+        buffer.counters.clear();
+    });
+}
+
+} // namespace BrakeCooling
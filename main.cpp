@@ -1,12 +1,24 @@
 #include "mainwindow.h"
 #include <QApplication>
+#include <QFile>
+#include "libBrakeCooling/include/trace.h"
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+    // QBRAKECOOLING_TRACE=<file> records a Chrome trace of the session, written on exit
+    const QString trace_file = qEnvironmentVariable("QBRAKECOOLING_TRACE");
+    BrakeCooling::Trace::setEnabled(!trace_file.isEmpty());
+
     MainWindow w;
     w.show();
 
-
-    return a.exec();
+    const int ret = a.exec();
+    if (!trace_file.isEmpty()) {
+        QFile trace(trace_file);
+        if (trace.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            trace.write(QByteArray::fromStdString(BrakeCooling::Trace::chromeTraceJson()));
+        qInfo().noquote() << QString::fromStdString(BrakeCooling::Trace::summary());
+    }
+    return ret;
 }
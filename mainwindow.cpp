@@ -3,19 +3,38 @@
 #include <QDebug>
 #include "globals.h"
 #include "database.h"
+#include "calculation.h"
+#include "solverdialog.h"
+#include "uncertaintydialog.h"
 #include <iostream>
 #include <QLCDNumber>
 #include <QLabel>
+#include <QMessageBox>
+#include <QtConcurrent>
 #include "libBrakeCooling/include/libBrakeCooling.h"
-
-#define DEB qDebug()
+#include "libBrakeCooling/include/trace.h"
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
 {
     ui->setupUi(this);
-    dbConnected = Database::connect();
+    // lookups of the calculation run on a worker thread. Their errors are shown in the status bar
+    // instead of interrupting the user with a message box.
+    Database::setErrorHandler([this](const QString &error_msg, QWidget *parent) {
+        if (QThread::currentThread() != thread()) {
+            const QString text = QString(error_msg).replace(QLatin1String("<br>"), QLatin1String(" "));
+            QMetaObject::invokeMethod(this, [this, text]() {
+                ui->statusbar->showMessage(tr("Database Error: ") + text, 10000);
+            });
+            return;
+        }
+        QMessageBox mb(parent);
+        mb.setText("<b>Database Error</b><br><br>" + error_msg);
+        mb.setIcon(QMessageBox::Warning);
+        mb.exec();
+    });
+    dbConnected = Database::connect(this);
     if (!dbConnected) {
         std::cout << "Unable to establish database connection. Exiting";
         qApp->quit();
@@ -63,19 +82,52 @@ MainWindow::MainWindow(QWidget *parent)
     ui->cautionFrame->setStyleSheet(Global::StyleSheets::CAUTION);
     ui->warningFrame->setStyleSheet(Global::StyleSheets::WARNING);
 
-    m_model = QStringLiteral("B_737_800WSFP1");
-    // get vectors for table values
-    vec_speed  = Database::getTableValues(m_model, Global::Parameter::Speed);
-    vec_weight = Database::getTableValues(m_model, Global::Parameter::Weight);
-    vec_temp   = Database::getTableValues(m_model, Global::Parameter::Temperature);
-    vec_alt    = Database::getTableValues(m_model, Global::Parameter::Altitude);
+    // every model listed in the database can be selected, its tables are loaded on first use
+    if (dbConnected)
+        ui->modelComboBox->addItems(ModelRegistry::getModelNames());
+    setModel();
+    QObject::connect(ui->modelComboBox, qOverload<int>(&QComboBox::currentIndexChanged),
+                     this, &MainWindow::setModel);
+    // tables changed on disk are reloaded in the background, calculations already running finish on the old ones
+    if (dbConnected)
+        ModelRegistry::watch(RELOAD_INTERVAL_MS, [this]() {
+            QMetaObject::invokeMethod(this, [this]() {
+                setModel();
+                scheduleCalculation();
+                ui->statusbar->showMessage(tr("Performance tables reloaded"), 5000);
+            });
+        });
+
+    auto *tools_menu = ui->menubar->addMenu(tr("&Tools"));
+    tools_menu->addAction(tr("&Limiting Weight / Speed..."), this, &MainWindow::openSolver);
+    tools_menu->addAction(tr("&Uncertainty..."), this, &MainWindow::openUncertainty);
+    tools_menu->addAction(tr("&Envelope Heatmap..."), this, &MainWindow::openHeatmap);
+
+    // recalculate whenever an input changes
+    m_calculation_pool.setMaxThreadCount(1);
+    m_debounce_timer.setSingleShot(true);
+    m_debounce_timer.setInterval(DEBOUNCE_MS);
+    QObject::connect(&m_debounce_timer, &QTimer::timeout, this, &MainWindow::startCalculation);
+    for (auto *spin_box : {ui->weightSpinBox, ui->tempSpinBox, ui->speedSpinBox, ui->altitudeSpinBox, ui->TaxiDistanceSpinBox})
+        QObject::connect(spin_box, qOverload<int>(&QSpinBox::valueChanged), this, &MainWindow::scheduleCalculation);
+    for (auto *combo_box : {ui->modelComboBox, ui->brakeCategoryComboBox})
+        QObject::connect(combo_box, qOverload<int>(&QComboBox::currentIndexChanged), this, &MainWindow::scheduleCalculation);
+
+    QObject::connect(&m_calculation_watcher, &QFutureWatcherBase::finished, this, [this]() {
+        if (!m_calculation_watcher.isCanceled())
+            emit calculationFinished(m_calculation_watcher.result());
+    });
+    QObject::connect(this, &MainWindow::calculationFinished, this, &MainWindow::showResult);
 
-    setBrakeVector();
-    QObject::connect(ui->brakeCategoryComboBox, &QComboBox::currentIndexChanged,
-                     this, &MainWindow::setBrakeVector);
+    if (dbConnected)
+        scheduleCalculation();
 }
 MainWindow::~MainWindow()
 {
+    ModelRegistry::watch(0);
+    m_debounce_timer.stop();
+    m_calculation_watcher.cancel();
+    m_calculation_pool.waitForDone();
     delete ui;
 }
 
@@ -89,134 +141,140 @@ void MainWindow::on_calcPushButton_clicked()
         return;
     }
 
-    const double reference_braking_energy = referenceBrakingEnergy();
-    brakingEvents(reference_braking_energy);
+    if (!m_profile || !m_profile->hasCompleteTables(Global::BrakeCategory(ui->brakeCategoryComboBox->currentIndex()))) {
+        QMessageBox mb(this);
+        mb.setText("No performance tables available for " + ui->modelComboBox->currentText() + '.');
+        mb.setIcon(QMessageBox::Critical);
+        mb.exec();
+        return;
+    }
+
+    m_debounce_timer.stop();
+    startCalculation();
 }
 
-double MainWindow::referenceBrakingEnergy()
+void MainWindow::scheduleCalculation()
 {
-    const auto speed  = BrakeCooling::Params(ui->speedSpinBox->value(), vec_speed);
-    const auto weight = BrakeCooling::Params(ui->weightSpinBox->value() / double(1000), vec_weight);
-    const auto temp   = BrakeCooling::Params(ui->tempSpinBox->value(), vec_temp);
-    const auto alt    = BrakeCooling::Params(ui->altitudeSpinBox->value() / double(1000), vec_alt);
+    m_debounce_timer.start();
+    updateHeatmap();
+}
 
-    DEB << Database::getRefBe(m_model, speed.getLowBorder(), weight.getLowBorder(), temp.getLowBorder(), alt.getLowBorder());
-    const auto ref_be_values = Database::getReferenceBrakingEnergyValues(m_model, speed, weight, temp, alt);
-    const auto ref_be = BrakeCooling::Interpol(speed, weight, temp, alt, ref_be_values);
+void MainWindow::startCalculation()
+{
+    if (!dbConnected || !m_profile || !m_profile->hasCompleteTables(Global::BrakeCategory(ui->brakeCategoryComboBox->currentIndex()))) {
+        ui->statusbar->showMessage(tr("No performance tables available for %1.").arg(ui->modelComboBox->currentText()));
+        return;
+    }
 
-    double reference_braking_energy = ref_be.getReferenceBrakingEnergy();
+    // A calculation still waiting for the thread is stale now and will not start. One that is already
+    // running can not be interrupted, but its result is not reported as the watcher follows the new one.
+    m_calculation_watcher.cancel();
+    const auto profile = m_profile;
+    const auto inputs = landingInputs();
+    const auto brake_category = Global::BrakeCategory(ui->brakeCategoryComboBox->currentIndex());
+    m_calculation_watcher.setFuture(QtConcurrent::run(&m_calculation_pool, [this, profile, inputs, brake_category]() {
+        return m_incremental_calculation.calculate(profile, inputs, brake_category);
+    }));
+}
 
-    if (ui->TaxiDistanceSpinBox->value() == 0)
-        return reference_braking_energy;
+void MainWindow::showResult(const BrakeCooling::LandingResult &result)
+{
+    BRAKECOOLING_TRACE_SCOPE("ui/update");
+    if (result.in_envelope)
+        ui->statusbar->clearMessage();
     else
-        return reference_braking_energy + ui->TaxiDistanceSpinBox->value();
+        ui->statusbar->showMessage(tr("Input outside of the performance tables, limited to the table values."));
+
+    brakingEvents(result.events);
 }
 
-void MainWindow::brakingEvents(const double &reference_braking_energy)
+BrakeCooling::LandingInputs MainWindow::landingInputs() const
 {
-    std::vector vec_reference_be = Database::getTableValues(m_model, Global::Parameter::RefBe);
-    const auto brake_category = Global::BrakeCategory(ui->brakeCategoryComboBox->currentIndex());
-    const BrakeCooling::Params ref_be_params(reference_braking_energy, vec_reference_be);
-
+    BrakeCooling::LandingInputs inputs;
+    inputs.speed         = ui->speedSpinBox->value();
+    inputs.weight        = ui->weightSpinBox->value();
+    inputs.temp          = ui->tempSpinBox->value();
+    inputs.alt           = ui->altitudeSpinBox->value();
+    inputs.taxi_distance = ui->TaxiDistanceSpinBox->value();
+    return inputs;
+}
 
-    QHash<QLCDNumber*, double> braking_events;
+void MainWindow::brakingEvents(const BrakeCooling::EventResults &results)
+{
     const QVector<QLCDNumber*> minute_displays = {
         ui->minutes_mm_idle, ui->minutes_abm_idle, ui->minutes_ab3_idle, ui->minutes_ab2_idle, ui->minutes_ab1_idle,
         ui->minutes_mm_revt, ui->minutes_abm_revt, ui->minutes_ab3_revt, ui->minutes_ab2_revt, ui->minutes_ab1_revt
     };
-    for (const auto& display : minute_displays)
-        display->setStyleSheet(QString());
-
-    int vector_index = 0;
-    for (int i = 0 ; i < 2; i++) {
-        bool rev_t = i;
-        for (int j = 0; j < 5; j++) {
-            auto event = Global::BrakingEvent(j);
-            const auto adjusted_be = adjustedBrakeEnergy(ref_be_params, event, rev_t);
-            if (adjusted_be > Database::getCautionValue(m_model, brake_category)) {
-                styleLCDNumber(adjusted_be, brake_category, minute_displays[vector_index]);
-                //DEB << "Caution - Adjusted BE: " << adjusted_be << " - Limit value: " << AdjustedBrakingEnergyParameters::getCautionValue(brake_category) << '(' << Global::BRAKE_CATEGORY_DISPLAY_NAMES.value(brake_category) << ')';
-            } else {
-                const auto adjusted_be_parameters = BrakeCooling::Params(adjusted_be, vec_brakes);
-                const auto cooling_time           = coolingTime(adjusted_be_parameters, brake_category);
-                DEB << adjusted_be_parameters.getInputParameter();
-                braking_events.insert(minute_displays[vector_index], cooling_time);
-            }
-            vector_index ++;
-        }
-    }
-
-    QHash<QLCDNumber*, double>::Iterator i;
-    for (i = braking_events.begin(); i != braking_events.end(); ++i) {
-        //DEB << "Setting: " << i.key()->objectName() << " to value: " << i.value();
-        if (i.value() >0)
-            i.key()->display(i.value());
-        else {
-            i.key()->display(QString());
-            i.key()->setStyleSheet(Global::StyleSheets::VALID);
-        }
-    }
+    for (int i = 0; i < minute_displays.size(); i++)
+        styleLCDNumber(results[i], minute_displays[i]);
 }
 
-void MainWindow::styleLCDNumber(const double &adjusted_braking_energy, Global::BrakeCategory brake_category, QLCDNumber *display)
+void MainWindow::styleLCDNumber(const BrakeCooling::EventResult &result, QLCDNumber *display)
 {
-    display->display(QString());
-    switch (brake_category) {
-    case Global::BrakeCategory::Steel:
-        if (adjusted_braking_energy > Database::getWarningValue(m_model, Global::BrakeCategory::Steel))
-            display->setStyleSheet(Global::StyleSheets::WARNING);
-        else
-            display->setStyleSheet(Global::StyleSheets::CAUTION);
+    switch (result.band) {
+    case BrakeCooling::CoolingBand::Cooling:
+        display->setStyleSheet(QString());
+        display->display(result.cooling_time);
+        break;
+    case BrakeCooling::CoolingBand::NoProcedure:
+        display->display(QString());
+        display->setStyleSheet(Global::StyleSheets::VALID);
+        break;
+    case BrakeCooling::CoolingBand::Caution:
+        display->display(QString());
+        display->setStyleSheet(Global::StyleSheets::CAUTION);
         break;
-    case Global::BrakeCategory::Carbon:
-        if (adjusted_braking_energy > Database::getWarningValue(m_model, Global::BrakeCategory::Carbon))
-            display->setStyleSheet(Global::StyleSheets::WARNING);
-        else
-            display->setStyleSheet(Global::StyleSheets::CAUTION);
+    case BrakeCooling::CoolingBand::Warning:
+        display->display(QString());
+        display->setStyleSheet(Global::StyleSheets::WARNING);
         break;
     }
 }
 
-double MainWindow::adjustedBrakeEnergy(const BrakeCooling::Params &ref_be_parameters, Global::BrakingEvent event, bool rev_t)
+void MainWindow::openSolver()
 {
-    // get Values
-    const auto &[ref_be_low, ref_be_high, ref_be_param] = ref_be_parameters.getValues();{}
-    const double value_low  = Database::getAdjustedBe(m_model, ref_be_low, event, rev_t);
-    const double value_high = Database::getAdjustedBe(m_model, ref_be_high, event, rev_t);
-
-    const auto ret = BrakeCooling::linearInterpol(ref_be_param, ref_be_low, value_low, ref_be_high, value_high);
-
-    // Debug
-    const char* rev = rev_t ? " - Second Detent" : " - Idle Reverse";
-    DEB << "Adjusted Brake Energy for event: " << Global::BRAKING_EVENT_DISPLAY_NAMES.value(event) << rev << ":" << ret;
-
-    return ret;
+    if (!m_profile || !m_profile->hasCompleteTables(Global::BrakeCategory(ui->brakeCategoryComboBox->currentIndex()))) {
+        ui->statusbar->showMessage(tr("No performance tables available for %1.").arg(ui->modelComboBox->currentText()));
+        return;
+    }
+    SolverDialog dialog(m_profile, landingInputs(), Global::BrakeCategory(ui->brakeCategoryComboBox->currentIndex()), this);
+    dialog.exec();
 }
 
-double MainWindow::coolingTime(const BrakeCooling::Params &adj_be, Global::BrakeCategory brake_category)
+void MainWindow::openUncertainty()
 {
-    const auto&[abe_low, abe_high, abe_param] = adj_be.getValues();{}
-    DEB << "Cooling Time Parameters received: " << abe_low << '/' << abe_high << '/' << abe_param;
-    if (abe_high == 0)
-        return -1; // No special procedure required per Brake Cooling Schedule
-    const double value_low = Database::getCoolingTime( m_model, brake_category, abe_low);
-    const double value_high = Database::getCoolingTime(m_model, brake_category, abe_high);
+    if (!m_profile || !m_profile->hasCompleteTables(Global::BrakeCategory(ui->brakeCategoryComboBox->currentIndex()))) {
+        ui->statusbar->showMessage(tr("No performance tables available for %1.").arg(ui->modelComboBox->currentText()));
+        return;
+    }
+    UncertaintyDialog dialog(m_profile, landingInputs(), Global::BrakeCategory(ui->brakeCategoryComboBox->currentIndex()), this);
+    dialog.exec();
+}
 
-    const auto ret = BrakeCooling::linearInterpol(abe_param, abe_low, value_low, abe_high, value_high);
-    DEB << "Cooling Time: " << ret << " minutes for category " << Global::BRAKE_CATEGORY_DISPLAY_NAMES.value(brake_category);
+void MainWindow::openHeatmap()
+{
+    if (!m_heatmap_dialog) {
+        m_heatmap_dialog = new HeatmapDialog(this);
+        m_heatmap_dialog->setAttribute(Qt::WA_DeleteOnClose);
+    }
+    updateHeatmap();
+    m_heatmap_dialog->show();
+    m_heatmap_dialog->raise();
+    m_heatmap_dialog->activateWindow();
+}
 
-    return ret;
+void MainWindow::updateHeatmap()
+{
+    if (m_heatmap_dialog)
+        m_heatmap_dialog->setInputs(m_profile, landingInputs(), Global::BrakeCategory(ui->brakeCategoryComboBox->currentIndex()));
 }
 
-void MainWindow::setBrakeVector()
+void MainWindow::setModel()
 {
-    switch (ui->brakeCategoryComboBox->currentIndex()) {
-    case 0:
-        vec_brakes = Database::getTableValues(m_model, Global::Parameter::AdjustedSteel);
-        break;
-    case 1:
-        vec_brakes = Database::getTableValues(m_model, Global::Parameter::AdjustedCarbon);
-        break;
+    if (ui->modelComboBox->currentIndex() < 0) {
+        m_profile.reset();
+        return;
     }
-    DEB << "Brakes reset: " << ui->brakeCategoryComboBox->currentText() << vec_brakes;
+    m_profile = ModelRegistry::getProfile(ui->modelComboBox->currentText());
+    DEB << "Model set: " << (m_profile ? m_profile->getName() : QString());
 }
@@ -3,8 +3,15 @@
 
 #include <QMainWindow>
 #include <QLCDNumber>
+#include <QPointer>
+#include <QFutureWatcher>
+#include <QThreadPool>
+#include <QTimer>
 #include "globals.h"
 #include "libBrakeCooling/include/libBrakeCooling.h"
+#include "modelprofile.h"
+#include "calculation.h"
+#include "heatmapdialog.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -18,27 +25,46 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+signals:
+    /*!
+     * \brief emitted on the GUI thread when the calculation for the current inputs has finished
+     */
+    void calculationFinished(const BrakeCooling::LandingResult &result);
+
 private slots:
     void on_calcPushButton_clicked();
-    void setBrakeVector();
+    void setModel();
+    void scheduleCalculation();
+    void startCalculation();
+    void showResult(const BrakeCooling::LandingResult &result);
+    void openSolver();
+    void openUncertainty();
+    void openHeatmap();
 
 private:
     Ui::MainWindow *ui;
     bool dbConnected;
     void tempCorrect(double x, double ref_be);
-    double referenceBrakingEnergy();
-    void brakingEvents(const double &reference_braking_energy);
-    void styleLCDNumber(const double &adjusted_braking_energy, Global::BrakeCategory brake_category, QLCDNumber *display);
-
-    std::vector<double> vec_speed;
-    std::vector<double> vec_weight;
-    std::vector<double> vec_temp;
-    std::vector<double> vec_alt;
-    std::vector<double> vec_brakes;
+    BrakeCooling::LandingInputs landingInputs() const;
+    void brakingEvents(const BrakeCooling::EventResults &results);
+    void styleLCDNumber(const BrakeCooling::EventResult &result, QLCDNumber *display);
+    void updateHeatmap();
+
     int weight_step = 500;
 
-    QString m_model;
-    double adjustedBrakeEnergy(const BrakeCooling::Params &ref_be_parameters, Global::BrakingEvent event, bool rev_t);
-    double coolingTime(const BrakeCooling::Params &adj_be, Global::BrakeCategory brake_category);
+    std::shared_ptr<const ModelProfile> m_profile;
+
+    // how often the database and the compiled tables are checked for changes, see ModelRegistry::watch()
+    static constexpr int RELOAD_INTERVAL_MS = 2000;
+    // input changes restart the timer, the calculation starts once the inputs have settled
+    static constexpr int DEBOUNCE_MS = 150;
+    QTimer m_debounce_timer;
+    // a single calculation thread, so a newer calculation queues behind at most one stale one
+    QThreadPool m_calculation_pool;
+    QFutureWatcher<BrakeCooling::LandingResult> m_calculation_watcher;
+    // only used by the calculation thread. Changing one input repeats the affected stages only.
+    IncrementalCalculation m_incremental_calculation;
+    // non-modal, follows every input change without waiting for the debounce timer
+    QPointer<HeatmapDialog> m_heatmap_dialog;
 };
 #endif // MAINWINDOW_H
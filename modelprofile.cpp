@@ -0,0 +1,275 @@
+#include "modelprofile.h"
+#include "database.h"
+#include "calculation.h"
+#include <QFile>
+#include <QSqlDatabase>
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+/*!
+ * \brief the second largest and the largest key of an adjusted brake energy column, which are the
+ * lower limits of the caution and warning bands
+ */
+void bandLimits(const BrakeCooling::GridAxis &axis, double &caution_value, double &warning_value)
+{
+    const auto &values = axis.getValues();
+    if (values.empty())
+        return;
+    warning_value = *std::max_element(values.begin(), values.end());
+    caution_value = 0;
+    for (const double value : values)
+        if (value < warning_value)
+            caution_value = std::max(caution_value, value);
+}
+
+const char *const STORAGE_NAMES[] = {"double", "float32", "fixed16", "fixed32"};
+
+} // namespace
+
+ModelProfile::ModelProfile(const QString &table_name, BrakeCooling::GridStorage storage, double max_storage_error)
+    : m_name(table_name)
+{
+    // curves are built from the tables in one piece: ten adjusted brake energy curves, followed by
+    // the cooling time curves of both brake categories
+    std::vector<double> adjusted_be;
+    std::vector<double> cooling_times[2];
+    m_table_file = Database::openTableFile(m_name);
+    if (m_table_file) {
+        DEB << "Using compiled tables" << Database::tableFileName(m_name);
+        m_reference_grid = m_table_file->getReferenceGrid();
+        m_ref_be_axis = m_table_file->getRefBeAxis();
+        m_adjusted_axes[0] = m_table_file->getAdjustedAxis(BrakeCooling::BrakeCategory::Steel);
+        m_adjusted_axes[1] = m_table_file->getAdjustedAxis(BrakeCooling::BrakeCategory::Carbon);
+        adjusted_be.assign(m_table_file->getAdjustedBe(BrakeCooling::BrakingEvent::MaxMan, false),
+                           m_table_file->getAdjustedBe(BrakeCooling::BrakingEvent::MaxMan, false) + 10 * m_ref_be_axis.size());
+        for (int i = 0; i < 2; i++) {
+            const double *cooling_time = m_table_file->getCoolingTime(BrakeCooling::BrakeCategory(i));
+            cooling_times[i].assign(cooling_time, cooling_time + m_adjusted_axes[i].size());
+        }
+    } else {
+        m_reference_grid = Database::getReferenceGrid(m_name);
+        m_ref_be_axis = BrakeCooling::GridAxis(Database::getTableValues(m_name, Global::Parameter::RefBe));
+        m_adjusted_axes[0] = BrakeCooling::GridAxis(Database::getTableValues(m_name, Global::Parameter::AdjustedSteel));
+        m_adjusted_axes[1] = BrakeCooling::GridAxis(Database::getTableValues(m_name, Global::Parameter::AdjustedCarbon));
+        adjusted_be = Database::getAdjustedBeTable(m_name, m_ref_be_axis);
+        for (int i = 0; i < 2; i++)
+            cooling_times[i] = Database::getCoolingTimeTable(m_name, Global::BrakeCategory(i), m_adjusted_axes[i]);
+    }
+
+    for (std::size_t i = 0; i < m_adjusted_be_curves.size(); i++)
+        m_adjusted_be_curves[i] = BrakeCooling::Curve1D(m_ref_be_axis, adjusted_be.data() + i * m_ref_be_axis.size());
+    for (int i = 0; i < 2; i++)
+        m_cooling_time_curves[i] = BrakeCooling::Curve1D(m_adjusted_axes[i], cooling_times[i].data());
+
+    for (int i = 0; i < 2; i++)
+        bandLimits(m_adjusted_axes[i], m_caution_values[i], m_warning_values[i]);
+
+    m_valid = m_reference_grid.isComplete() && !m_ref_be_axis.isEmpty()
+            && !m_adjusted_axes[0].isEmpty() && !m_adjusted_axes[1].isEmpty();
+    DEB << "Loaded profile" << m_name << (m_valid ? "" : "(incomplete)")
+        << "caution:" << m_caution_values[0] << m_caution_values[1]
+        << "warning:" << m_warning_values[0] << m_warning_values[1];
+
+    if (storage != BrakeCooling::GridStorage::Double && m_valid)
+        useCompactStorage(storage, max_storage_error);
+
+    // unique per instance, so results of replaced profiles never match
+    static std::atomic<std::uint64_t> instance_count{0};
+    m_cache_key = QStringLiteral("%1#%2/%3").arg(m_name).arg(++instance_count)
+                  .arg(QLatin1String(STORAGE_NAMES[static_cast<int>(m_reference_grid.getStorage())])).toStdString();
+}
+
+void ModelProfile::useCompactStorage(BrakeCooling::GridStorage storage, double max_storage_error)
+{
+    const auto compact = m_reference_grid.withStorage(storage);
+    for (int i = 0; i < 2; i++) {
+        const auto brake_category = Global::BrakeCategory(i);
+        if (!hasCompleteTables(brake_category))
+            continue;
+        const auto error = BrakeCooling::measureStorageError(getPerformanceTables(brake_category), compact);
+        m_storage_error.reference_be = std::max(m_storage_error.reference_be, error.reference_be);
+        m_storage_error.cooling_time = std::max(m_storage_error.cooling_time, error.cooling_time);
+        m_storage_error.band_changes += error.band_changes;
+        m_storage_error.evaluations  += error.evaluations;
+    }
+
+    const bool accepted = m_storage_error.cooling_time <= max_storage_error && m_storage_error.band_changes == 0;
+    qInfo().noquote() << QStringLiteral("%1 %2 %3 storage: max. cooling time error %4 min, max. reference BE error %5, "
+                                        "%6 band changes in %7 landings, %8 instead of %9 bytes")
+                         .arg(m_name, QLatin1String(accepted ? "uses" : "rejected"), QLatin1String(STORAGE_NAMES[static_cast<int>(storage)]))
+                         .arg(m_storage_error.cooling_time).arg(m_storage_error.reference_be)
+                         .arg(m_storage_error.band_changes).arg(m_storage_error.evaluations)
+                         .arg(compact.getStorageSize()).arg(m_reference_grid.getStorageSize());
+    if (accepted)
+        m_reference_grid = compact;
+}
+
+bool ModelProfile::hasCompleteTables(Global::BrakeCategory brake_category) const
+{
+    return m_valid
+            && std::all_of(m_adjusted_be_curves.begin(), m_adjusted_be_curves.end(),
+                           [](const BrakeCooling::Curve1D &curve) {return curve.isComplete();})
+            && getCoolingTimeCurve(brake_category).isComplete();
+}
+
+BrakeCooling::PerformanceTables ModelProfile::getPerformanceTables(Global::BrakeCategory brake_category) const
+{
+    BrakeCooling::PerformanceTables tables;
+    tables.grid          = &m_reference_grid;
+    tables.adjusted_be   = m_adjusted_be_curves.data();
+    tables.cooling_time  = &getCoolingTimeCurve(brake_category);
+    tables.caution_value = getCautionValue(brake_category);
+    tables.warning_value = getWarningValue(brake_category);
+    return tables;
+}
+
+QStringList ModelRegistry::getModelNames()
+{
+    QMutexLocker lock(&mutex);
+    if (modelNames.isEmpty())
+        modelNames = Database::getModelNames();
+    return modelNames;
+}
+
+std::shared_ptr<const ModelProfile> ModelRegistry::getProfile(const QString &model)
+{
+    const QString table_name = tableName(model);
+    if (auto profile = profiles.load()->value(table_name))
+        return profile;
+
+    QMutexLocker lock(&mutex);
+    // another thread may have loaded it in the meantime
+    const auto current = profiles.load();
+    if (auto profile = current->value(table_name))
+        return profile;
+    // the name ends up in the queries as table prefix, only models listed in MODELS are loaded
+    if (modelNames.isEmpty())
+        modelNames = Database::getModelNames();
+    if (std::none_of(modelNames.cbegin(), modelNames.cend(), [&](const QString &name) {return tableName(name) == table_name;}))
+        return nullptr;
+    auto profile = std::make_shared<const ModelProfile>(table_name, gridStorage, maxStorageError);
+    auto updated = std::make_shared<Profiles>(*current);
+    updated->insert(table_name, profile);
+    profiles.publish(std::move(updated));
+    return profile;
+}
+
+bool ModelRegistry::parseStorage(const QString &name, BrakeCooling::GridStorage &storage)
+{
+    for (int i = 0; i < 4; i++) {
+        if (name.compare(QLatin1String(STORAGE_NAMES[i]), Qt::CaseInsensitive) == 0) {
+            storage = BrakeCooling::GridStorage(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ModelRegistry::parseBrakeCategory(const QByteArray &value, Global::BrakeCategory &brake_category)
+{
+    if (value == "0" || value.compare("C", Qt::CaseInsensitive) == 0 || value.compare("Steel", Qt::CaseInsensitive) == 0)
+        brake_category = Global::BrakeCategory::Steel;
+    else if (value == "1" || value.compare("N", Qt::CaseInsensitive) == 0 || value.compare("Carbon", Qt::CaseInsensitive) == 0)
+        brake_category = Global::BrakeCategory::Carbon;
+    else
+        return false;
+    return true;
+}
+
+void ModelRegistry::setStorage(BrakeCooling::GridStorage storage, double max_error)
+{
+    QMutexLocker lock(&mutex);
+    gridStorage = storage;
+    maxStorageError = max_error;
+}
+
+QString ModelRegistry::tableName(const QString &model)
+{
+    return QString(model).replace(QLatin1Char('-'), QLatin1Char('_'));
+}
+
+void ModelRegistry::clear()
+{
+    QMutexLocker lock(&mutex);
+    modelNames.clear();
+    profiles.publish(std::make_shared<const Profiles>());
+    Calculation::resultCache().clear(false);
+}
+
+void ModelRegistry::watch(int interval_ms, std::function<void()> on_reload)
+{
+    // stopped without holding the lock, a reload in progress needs it to finish
+    std::unique_ptr<BrakeCooling::FileWatcher> previous;
+    {
+        QMutexLocker lock(&mutex);
+        previous = std::move(watcher);
+    }
+    previous.reset();
+    if (interval_ms <= 0)
+        return;
+
+    // in WAL mode, commits only reach the database file itself at the next checkpoint
+    const QString &db_file = Database::getFileName();
+    std::vector<std::string> files;
+    for (const QString &file : {db_file, db_file + QLatin1String("-wal")})
+        files.push_back(QFile::encodeName(file).toStdString());
+    for (const QString &model : getModelNames())
+        files.push_back(QFile::encodeName(Database::tableFileName(tableName(model))).toStdString());
+
+    QMutexLocker lock(&mutex);
+    reloadHandler = std::move(on_reload);
+    watcher = std::make_unique<BrakeCooling::FileWatcher>(std::move(files), std::chrono::milliseconds(interval_ms),
+                                                          &ModelRegistry::reload);
+}
+
+void ModelRegistry::reload()
+{
+    BrakeCooling::GridStorage storage;
+    double max_storage_error;
+    std::shared_ptr<const Profiles> current;
+    {
+        QMutexLocker lock(&mutex);
+        storage = gridStorage;
+        max_storage_error = maxStorageError;
+        current = profiles.load();
+    }
+
+    // loaded without the lock, getProfile() goes on handing out the current profiles. A single read
+    // transaction, so all profiles see the same state of the database.
+    QSqlDatabase db = Database::database();
+    db.transaction();
+    Profiles reloaded;
+    for (auto it = current->cbegin(); it != current->cend(); ++it) {
+        auto profile = std::make_shared<const ModelProfile>(it.key(), storage, max_storage_error);
+        if (it.value()->isValid() && !profile->isValid()) {
+            db.rollback();
+            qWarning().noquote() << "Unable to reload" << it.key() << "- keeping the current tables";
+            return;
+        }
+        reloaded.insert(it.key(), std::move(profile));
+    }
+    const QStringList model_names = Database::getModelNames();
+    db.rollback();
+
+    std::function<void()> handler;
+    {
+        QMutexLocker lock(&mutex);
+        // profiles loaded by getProfile() during the reload have already seen the changed files
+        const auto latest = profiles.load();
+        for (auto it = latest->cbegin(); it != latest->cend(); ++it)
+            if (!reloaded.contains(it.key()))
+                reloaded.insert(it.key(), it.value());
+        modelNames = model_names;
+        profiles.publish(std::make_shared<const Profiles>(std::move(reloaded)));
+        reloads.fetch_add(1, std::memory_order_release);
+        // keyed on the replaced profiles, they would never be hit again. The counters cover the whole
+        // run, so they are kept.
+        Calculation::resultCache().clear(false);
+        handler = reloadHandler;
+    }
+    qInfo().noquote() << QStringLiteral("Reloaded the tables of %1 models").arg(current->size());
+    if (handler)
+        handler();
+}
@@ -0,0 +1,201 @@
+#ifndef MODELPROFILE_H
+#define MODELPROFILE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QStringList>
+#include <functional>
+#include <memory>
+#include <string>
+#include "globals.h"
+#include "libBrakeCooling/include/libBrakeCooling.h"
+#include "libBrakeCooling/include/tableFile.h"
+#include "libBrakeCooling/include/performanceTables.h"
+#include "libBrakeCooling/include/snapshot.h"
+
+/*!
+ * \brief The tables and limits of one aircraft model
+ * \details Loaded once from the compiled tables if present, from the database otherwise, and not
+ * changed afterwards, so a profile can be shared between threads. Obtain profiles from ModelRegistry.
+ *
+ * If a compact storage is requested, the reference grid is converted after loading and the cooling
+ * times calculated on it are compared with the ones of the double grid, see
+ * BrakeCooling::measureStorageError(). The compact grid is only used if no cooling time differs by more
+ * than max_storage_error minutes and no braking event changes its band, otherwise the profile keeps
+ * the double grid.
+ */
+class ModelProfile
+{
+public:
+    explicit ModelProfile(const QString &table_name,
+                          BrakeCooling::GridStorage storage = BrakeCooling::GridStorage::Double,
+                          double max_storage_error = 0);
+
+    /*!
+     * \brief the table name prefix, e.g. B_737_800WSFP1
+     */
+    const QString &getName() const {return m_name;}
+
+    /*!
+     * \brief false if the reference grid or the key values of the model could not be loaded
+     */
+    bool isValid() const {return m_valid;}
+
+    /*!
+     * \brief the compiled tables the profile was loaded from, nullptr if it was loaded from the database
+     */
+    const std::shared_ptr<const BrakeCooling::TableFile> &getTableFile() const {return m_table_file;}
+
+    const BrakeCooling::ReferenceGrid &getReferenceGrid() const {return m_reference_grid;}
+    const BrakeCooling::GridAxis &getRefBeAxis() const {return m_ref_be_axis;}
+    const BrakeCooling::GridAxis &getAdjustedAxis(Global::BrakeCategory brake_category) const
+    {return m_adjusted_axes[static_cast<int>(brake_category)];}
+
+    /*!
+     * \brief the adjusted brake energy curves over getRefBeAxis(), one per braking event in
+     * BrakeCooling::eventIndex() order
+     */
+    const std::array<BrakeCooling::Curve1D, 10> &getAdjustedBeCurves() const {return m_adjusted_be_curves;}
+
+    /*!
+     * \brief the cooling time curve over getAdjustedAxis(brake_category)
+     */
+    const BrakeCooling::Curve1D &getCoolingTimeCurve(Global::BrakeCategory brake_category) const
+    {return m_cooling_time_curves[static_cast<int>(brake_category)];}
+
+    /*!
+     * \brief adjusted brake energies above this value are in the caution band
+     */
+    double getCautionValue(Global::BrakeCategory brake_category) const {return m_caution_values[static_cast<int>(brake_category)];}
+
+    /*!
+     * \brief adjusted brake energies above this value are in the warning band
+     */
+    double getWarningValue(Global::BrakeCategory brake_category) const {return m_warning_values[static_cast<int>(brake_category)];}
+
+    /*!
+     * \brief true if the profile is valid and the curves of a brake category have a value for every key
+     */
+    bool hasCompleteTables(Global::BrakeCategory brake_category) const;
+
+    /*!
+     * \brief the tables of a brake category for the in-memory calculations of libBrakeCooling. They
+     * point into the profile, which has to be kept alive while they are used. Only meaningful if
+     * hasCompleteTables() is true.
+     */
+    BrakeCooling::PerformanceTables getPerformanceTables(Global::BrakeCategory brake_category) const;
+
+    /*!
+     * \brief the largest deviation of both brake categories caused by the requested compact storage,
+     * all zero if none was requested. getReferenceGrid().getStorage() tells if it has been accepted.
+     */
+    const BrakeCooling::StorageError &getStorageError() const {return m_storage_error;}
+
+    /*!
+     * \brief identifies the tables of this profile in a BrakeCooling::ResultCache: the name, the storage
+     * of the reference grid and a number unique to every ModelProfile instance, so results calculated
+     * on a profile that has since been cleared or reloaded are not served for another one
+     */
+    const std::string &getCacheKey() const {return m_cache_key;}
+private:
+    void useCompactStorage(BrakeCooling::GridStorage storage, double max_storage_error);
+
+    QString m_name;
+    bool m_valid = false;
+    std::shared_ptr<const BrakeCooling::TableFile> m_table_file;
+    BrakeCooling::ReferenceGrid m_reference_grid;
+    BrakeCooling::GridAxis m_ref_be_axis;
+    BrakeCooling::GridAxis m_adjusted_axes[2];
+    std::array<BrakeCooling::Curve1D, 10> m_adjusted_be_curves;
+    BrakeCooling::Curve1D m_cooling_time_curves[2];
+    double m_caution_values[2] = {-1, -1};
+    double m_warning_values[2] = {-1, -1};
+    BrakeCooling::StorageError m_storage_error;
+    std::string m_cache_key;
+};
+
+/*!
+ * \brief Hands out the ModelProfile of every model listed in the MODELS table
+ * \details Profiles are loaded on first use and kept until clear() is called. All methods can be
+ * called from any thread once the database connection has been established.
+ *
+ * The loaded profiles form one immutable snapshot (see BrakeCooling::Snapshot), which is replaced as
+ * a whole. Looking up a loaded profile takes no lock, and a caller keeps the profile it got for as
+ * long as it holds it, so a calculation or batch never mixes tables of two versions. With watch(),
+ * changes of the database or of the compiled tables are picked up in the background: all loaded
+ * profiles are rebuilt off the calling threads and published together once every one has loaded.
+ * The results cached by Calculation::cachedLanding() are dropped with them.
+ */
+class ModelRegistry
+{
+public:
+    /*!
+     * \brief the model names as listed in the MODELS table, e.g. B-737-800WSFP1
+     */
+    static QStringList getModelNames();
+
+    /*!
+     * \brief the profile of a model, given either as listed in MODELS or as table name prefix.
+     * nullptr if the model is not listed in MODELS.
+     */
+    static std::shared_ptr<const ModelProfile> getProfile(const QString &model);
+
+    /*!
+     * \brief the table name prefix of a model listed in MODELS
+     */
+    static QString tableName(const QString &model);
+
+    /*!
+     * \brief the storage of the reference grids of profiles loaded from now on, accepted per model if
+     * the cooling times differ by at most max_error minutes. Call clear() to reload loaded profiles.
+     */
+    static void setStorage(BrakeCooling::GridStorage storage, double max_error);
+
+    /*!
+     * \brief converts double, float32, fixed16 or fixed32 to a storage, returns false for other names
+     */
+    static bool parseStorage(const QString &name, BrakeCooling::GridStorage &storage);
+
+    /*!
+     * \brief converts 0, C or Steel and 1, N or Carbon, in any case, returns false for other values
+     */
+    static bool parseBrakeCategory(const QByteArray &value, Global::BrakeCategory &brake_category);
+
+    /*!
+     * \brief drops all profiles and the cached results calculated on them, they are loaded again on next use
+     */
+    static void clear();
+
+    /*!
+     * \brief polls the database and the compiled tables of all models every interval_ms and reloads
+     * the loaded profiles when one of them has changed. on_reload is called on the watcher thread
+     * after a new snapshot has been published. An interval of 0 stops watching, which has to be done
+     * before the application object is destroyed.
+     */
+    static void watch(int interval_ms, std::function<void()> on_reload = {});
+
+    /*!
+     * \brief incremented whenever a reload has been published, to notice new tables without a lookup
+     */
+    static std::uint64_t getVersion() {return reloads.load(std::memory_order_acquire);}
+private:
+    using Profiles = QHash<QString, std::shared_ptr<const ModelProfile>>;
+
+    /*!
+     * \brief rebuilds all loaded profiles, keeps the current ones if any fails to load
+     */
+    static void reload();
+
+    // serializes the writers of profiles, readers go without
+    static inline QMutex mutex;
+    static inline BrakeCooling::GridStorage gridStorage = BrakeCooling::GridStorage::Double;
+    static inline double maxStorageError = 0;
+    static inline QStringList modelNames;
+    static inline BrakeCooling::Snapshot<Profiles> profiles;
+    static inline std::atomic<std::uint64_t> reloads{0};
+    static inline std::function<void()> reloadHandler;
+    // declared last, so it is stopped before the members it uses are destroyed
+    static inline std::unique_ptr<BrakeCooling::FileWatcher> watcher;
+};
+
+#endif // MODELPROFILE_H
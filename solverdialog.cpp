@@ -0,0 +1,97 @@
+#include "solverdialog.h"
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QVBoxLayout>
+
+SolverDialog::SolverDialog(std::shared_ptr<const ModelProfile> profile,
+                           const BrakeCooling::LandingInputs &inputs,
+                           Global::BrakeCategory brake_category,
+                           QWidget *parent)
+    : QDialog(parent)
+    , m_profile(std::move(profile))
+    , m_inputs(inputs)
+    , m_brake_category(brake_category)
+{
+    setWindowTitle(tr("Limiting Weight / Speed"));
+
+    m_parameter_combo_box = new QComboBox(this);
+    m_parameter_combo_box->addItem(tr("Maximum landing weight"), int(BrakeCooling::SolveParameter::Weight));
+    m_parameter_combo_box->addItem(tr("Maximum landing speed"), int(BrakeCooling::SolveParameter::Speed));
+
+    m_target_combo_box = new QComboBox(this);
+    m_target_combo_box->addItem(tr("Cooling time at most"), int(BrakeCooling::SolveTarget::CoolingTime));
+    m_target_combo_box->addItem(tr("Below caution"), int(BrakeCooling::SolveTarget::NoCaution));
+    m_target_combo_box->addItem(tr("Below warning"), int(BrakeCooling::SolveTarget::NoWarning));
+
+    m_minutes_spin_box = new QSpinBox(this);
+    m_minutes_spin_box->setRange(0, 120);
+    m_minutes_spin_box->setValue(30);
+    m_minutes_spin_box->setSuffix(tr(" min"));
+
+    auto *form = new QFormLayout;
+    form->addRow(tr("Solve for"), m_parameter_combo_box);
+    form->addRow(tr("Target"), m_target_combo_box);
+    form->addRow(tr("Cooling time"), m_minutes_spin_box);
+
+    m_results_table = new QTableWidget(5, 2, this);
+    m_results_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_results_table->setHorizontalHeaderLabels({Global::REVERSE_THRUST_DISPLAY_NAMES.value(false),
+                                                Global::REVERSE_THRUST_DISPLAY_NAMES.value(true)});
+    QStringList events;
+    for (const auto &name : Global::BRAKING_EVENT_DISPLAY_NAMES)
+        events.append(name);
+    m_results_table->setVerticalHeaderLabels(events);
+    m_results_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    QObject::connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    auto *layout = new QVBoxLayout(this);
+    layout->addLayout(form);
+    layout->addWidget(m_results_table);
+    layout->addWidget(new QLabel(tr("Other inputs as entered in the main window. ≥ means the target is met "
+                                    "up to the end of the performance tables."), this));
+    layout->addWidget(buttons);
+
+    QObject::connect(m_parameter_combo_box, qOverload<int>(&QComboBox::currentIndexChanged), this, &SolverDialog::solve);
+    QObject::connect(m_target_combo_box, qOverload<int>(&QComboBox::currentIndexChanged), this, &SolverDialog::solve);
+    QObject::connect(m_minutes_spin_box, qOverload<int>(&QSpinBox::valueChanged), this, &SolverDialog::solve);
+    solve();
+}
+
+void SolverDialog::solve()
+{
+    BrakeCooling::InverseProblem problem;
+    problem.inputs = m_inputs;
+    problem.parameter = BrakeCooling::SolveParameter(m_parameter_combo_box->currentData().toInt());
+    problem.target = BrakeCooling::SolveTarget(m_target_combo_box->currentData().toInt());
+    problem.max_cooling_time = m_minutes_spin_box->value();
+    m_minutes_spin_box->setEnabled(problem.target == BrakeCooling::SolveTarget::CoolingTime);
+
+    const auto results = Calculation::inverse(*m_profile, problem, m_brake_category);
+    const bool by_weight = problem.parameter == BrakeCooling::SolveParameter::Weight;
+    for (int column = 0; column < 2; column++) {
+        for (int row = 0; row < 5; row++) {
+            const auto &result = results[BrakeCooling::eventIndex(BrakeCooling::BrakingEvent(row), column)];
+            QString text;
+            switch (result.status) {
+            case BrakeCooling::SolveStatus::Limited:
+                text = by_weight ? tr("%1 kg").arg(std::floor(result.limit), 0, 'f', 0)
+                                 : tr("%1 kt").arg(std::floor(result.limit * 10) / 10, 0, 'f', 1);
+                break;
+            case BrakeCooling::SolveStatus::Unlimited:
+                text = by_weight ? tr("≥ %1 kg").arg(result.limit, 0, 'f', 0)
+                                 : tr("≥ %1 kt").arg(result.limit, 0, 'f', 0);
+                break;
+            case BrakeCooling::SolveStatus::Infeasible:
+                text = tr("not achievable");
+                break;
+            }
+            auto *item = new QTableWidgetItem(text);
+            item->setTextAlignment(Qt::AlignCenter);
+            m_results_table->setItem(row, column, item);
+        }
+    }
+}
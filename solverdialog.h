@@ -0,0 +1,38 @@
+#ifndef SOLVERDIALOG_H
+#define SOLVERDIALOG_H
+
+#include <QDialog>
+#include <QComboBox>
+#include <QSpinBox>
+#include <QTableWidget>
+#include "calculation.h"
+
+/*!
+ * \brief Shows the largest landing weight or speed that meets a cooling target, for all braking events
+ * \details The other inputs are taken from the main window when the dialog is opened. Results are
+ * updated whenever the target changes.
+ */
+class SolverDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    SolverDialog(std::shared_ptr<const ModelProfile> profile,
+                 const BrakeCooling::LandingInputs &inputs,
+                 Global::BrakeCategory brake_category,
+                 QWidget *parent = nullptr);
+
+private slots:
+    void solve();
+
+private:
+    std::shared_ptr<const ModelProfile> m_profile;
+    BrakeCooling::LandingInputs m_inputs;
+    Global::BrakeCategory m_brake_category;
+
+    QComboBox *m_parameter_combo_box;
+    QComboBox *m_target_combo_box;
+    QSpinBox *m_minutes_spin_box;
+    QTableWidget *m_results_table;
+};
+
+#endif // SOLVERDIALOG_H
@@ -0,0 +1,254 @@
+/*
+ * bench - measures the stages of the brake cooling calculation
+ *
+ * A synthetic database with the layout of database/database.db is generated in a temporary
+ * directory (see SyntheticDatabase) and every stage is timed on its own: parameter bracketing,
+ * Interpol construction, the batch interpolation, each Database lookup, mapping compiled tables and the complete
+ * calculation behind the Calculate button. The results are written as one JSON document, a
+ * human readable summary goes to standard error.
+ */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <chrono>
+#include <random>
+#include <thread>
+#include "database.h"
+#include "calculation.h"
+#include "syntheticdatabase.h"
+
+namespace {
+
+// results are written here so that the compiler can not optimise the measured work away
+volatile double sink;
+
+class Benchmark
+{
+public:
+    explicit Benchmark(double scale) : m_scale(scale) {}
+
+    /*!
+     * \brief calls function(i) for i in [0, iterations) and records the time per operation,
+     * where one call performs items_per_call operations
+     */
+    template <typename Function>
+    void run(const QString &name, int iterations, Function &&function, int items_per_call = 1)
+    {
+        iterations = std::max(1, static_cast<int>(iterations * m_scale));
+        for (int i = 0; i < std::min(iterations, 100); i++) // warm up
+            function(i);
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+            function(i);
+        const double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+        const double ns_per_op = elapsed / (double(iterations) * items_per_call);
+        QJsonObject result;
+        result.insert("name", name);
+        result.insert("operations", double(iterations) * items_per_call);
+        result.insert("ns_per_op", ns_per_op);
+        result.insert("ops_per_s", 1e9 / ns_per_op);
+        m_results.append(result);
+        qInfo().noquote() << QString("%1 %2 ns/op").arg(name, -36).arg(ns_per_op, 14, 'f', 1);
+    }
+
+    QJsonArray getResults() const {return m_results;}
+private:
+    double m_scale;
+    QJsonArray m_results;
+};
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmarks the brake cooling calculation against a synthetic database.");
+    parser.addHelpOption();
+    const QCommandLineOption output_option(QStringList{"o", "output"}, "Write the JSON results to file instead of standard output.", "file");
+    const QCommandLineOption scale_option(QStringList{"s", "scale"}, "Multiply all iteration counts by factor.", "factor", "1");
+    parser.addOption(output_option);
+    parser.addOption(scale_option);
+    parser.process(app);
+
+    QTemporaryDir dir;
+    const QString db_file = dir.filePath("synthetic.db");
+    QString error;
+    if (!dir.isValid() || !SyntheticDatabase::create(db_file, &error)) {
+        qCritical().noquote() << "Unable to create the synthetic database:" << error;
+        return 1;
+    }
+    if (!Database::connect(nullptr, db_file))
+        return 1;
+
+    const QString model = SyntheticDatabase::MODEL;
+    const auto profile = ModelRegistry::getProfile(model);
+    const auto &grid = profile->getReferenceGrid();
+    const auto &ref_be_axis = profile->getRefBeAxis();
+    const auto &brakes_axis = profile->getAdjustedAxis(Global::BrakeCategory::Steel);
+    std::vector<double> irregular_speeds = grid.getSpeeds();
+    irregular_speeds.push_back(irregular_speeds.back() + 1); // breaks the constant step
+    const BrakeCooling::GridAxis irregular_axis(irregular_speeds);
+
+    // random landings within the input range of the user interface
+    constexpr int N = 4096;
+    std::mt19937 generator(42);
+    std::vector<BrakeCooling::LandingInputs> inputs(N);
+    std::vector<double> speeds(N), weights(N), temps(N), alts(N), ref_bes(N);
+    for (int i = 0; i < N; i++) {
+        inputs[i].speed  = std::uniform_int_distribution<int>(80, 180)(generator);
+        inputs[i].weight = std::uniform_int_distribution<int>(40000, 80000)(generator);
+        inputs[i].temp   = std::uniform_int_distribution<int>(0, 50)(generator);
+        inputs[i].alt    = std::uniform_int_distribution<int>(0, 10000)(generator);
+        speeds[i]  = inputs[i].speed;
+        weights[i] = inputs[i].weight / 1000;
+        temps[i]   = inputs[i].temp;
+        alts[i]    = inputs[i].alt / 1000;
+    }
+    std::vector<BrakeCooling::Params> speed_params, weight_params, temp_params, alt_params;
+    for (int i = 0; i < N; i++) {
+        speed_params.emplace_back(speeds[i], grid.getSpeedAxis());
+        weight_params.emplace_back(weights[i], grid.getWeightAxis());
+        temp_params.emplace_back(temps[i], grid.getTempAxis());
+        alt_params.emplace_back(alts[i], grid.getAltAxis());
+    }
+
+    Benchmark bench(parser.value(scale_option).toDouble());
+    const auto steel = Global::BrakeCategory::Steel;
+
+    bench.run("params/vector", 200000, [&](int i) {
+        sink = BrakeCooling::Params(speeds[i % N], grid.getSpeeds()).getLowBorder();
+    });
+    bench.run("params/axis_binary_search", 2000000, [&](int i) {
+        sink = BrakeCooling::Params(speeds[i % N], irregular_axis).getLowBorder();
+    });
+    bench.run("params/axis_uniform", 2000000, [&](int i) {
+        sink = BrakeCooling::Params(weights[i % N], grid.getWeightAxis()).getLowBorder();
+    });
+    bench.run("interpol/construction", 1000000, [&](int i) {
+        const int k = i % N;
+        sink = BrakeCooling::Interpol(speed_params[k], weight_params[k], temp_params[k], alt_params[k], grid).getReferenceBrakingEnergy();
+    });
+    bench.run("interpol/batch", 500, [&](int) {
+        BrakeCooling::interpolateBatch(grid, speeds.data(), weights.data(), temps.data(), alts.data(), ref_bes.data(), N);
+        sink = ref_bes[0];
+    }, N);
+
+    bench.run("database/getReferenceGrid", 20, [&](int) {
+        sink = Database::getReferenceGrid(model).getValue(0, 0, 0, 0);
+    });
+    bench.run("model_profile/load", 20, [&](int) {
+        sink = ModelProfile(model).getCautionValue(steel);
+    });
+    const std::string table_file_name = QFile::encodeName(dir.filePath("synthetic.bct")).toStdString();
+    if (BrakeCooling::TableFile::write(table_file_name, Database::getTableData(model))) {
+        bench.run("table_file/open", 2000, [&](int) {
+            sink = BrakeCooling::TableFile::open(table_file_name)->getReferenceGrid().getValue(0, 0, 0, 0);
+        });
+    }
+    bench.run("database/getRefBe", 2000, [&](int i) {
+        sink = Database::getRefBe(model, speed_params[i % N].getLowBorder(), weight_params[i % N].getLowBorder(),
+                                  temp_params[i % N].getLowBorder(), alt_params[i % N].getLowBorder());
+    });
+    bench.run("database/getAdjustedBe", 2000, [&](int i) {
+        sink = Database::getAdjustedBe(model, ref_be_axis[i % ref_be_axis.size()], Global::BrakingEvent(i % 5), i % 2);
+    });
+    bench.run("database/getCoolingTime", 2000, [&](int i) {
+        sink = Database::getCoolingTime(model, steel, brakes_axis[i % brakes_axis.size()]);
+    });
+    bench.run("database/getCautionValue", 2000, [&](int) {
+        sink = Database::getCautionValue(model, steel);
+    });
+    bench.run("database/getWarningValue", 2000, [&](int) {
+        sink = Database::getWarningValue(model, steel);
+    });
+
+    bench.run("end_to_end/landing", 200, [&](int i) {
+        sink = Calculation::landing(*profile, inputs[i % N], steel).reference_be;
+    });
+    // sweeps varying one input at a time, only the downstream stages are repeated
+    IncrementalCalculation incremental;
+    bench.run("incremental/taxi_distance_sweep", 200, [&](int i) {
+        BrakeCooling::LandingInputs landing = inputs[0];
+        landing.taxi_distance = i % 10;
+        sink = incremental.calculate(profile, landing, steel).reference_be;
+    });
+    bench.run("incremental/brake_category_toggle", 2000, [&](int i) {
+        sink = incremental.calculate(profile, inputs[0], Global::BrakeCategory(i % 2)).reference_be;
+    });
+
+    // the same landings spread over all cores, every thread using its own connection
+    const int thread_count = std::max(1u, std::thread::hardware_concurrency());
+    constexpr int LANDINGS_PER_THREAD = 50;
+    bench.run("end_to_end/landing_parallel", 4, [&](int i) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_count; t++)
+            threads.emplace_back([&, t]() {
+                for (int k = 0; k < LANDINGS_PER_THREAD; k++) {
+                    const auto &landing = inputs[(i * thread_count * LANDINGS_PER_THREAD + t * LANDINGS_PER_THREAD + k) % N];
+                    sink = Calculation::landing(*profile, landing, steel).reference_be;
+                }
+            });
+        for (auto &thread : threads)
+            thread.join();
+    }, thread_count * LANDINGS_PER_THREAD);
+    // uncertainty mode on the in-memory tables, all cores
+    BrakeCooling::UncertainInputs uncertain_inputs;
+    uncertain_inputs.speed  = {BrakeCooling::DistributionType::Normal, inputs[0].speed, 5};
+    uncertain_inputs.weight = {BrakeCooling::DistributionType::Normal, inputs[0].weight, 1000};
+    uncertain_inputs.temp   = {BrakeCooling::DistributionType::Normal, inputs[0].temp, 3};
+    uncertain_inputs.alt    = {BrakeCooling::DistributionType::Fixed, inputs[0].alt, 0};
+    BrakeCooling::MonteCarloSettings monte_carlo_settings;
+    monte_carlo_settings.samples = 100000;
+    bench.run("monte_carlo/sample", 2, [&](int i) {
+        monte_carlo_settings.seed = i;
+        sink = Calculation::monteCarlo(*profile, uncertain_inputs, monte_carlo_settings, steel).events[0].p90;
+    }, int(monte_carlo_settings.samples));
+    // the batched evaluation QBrakeCoolingService runs on coalesced requests
+    const auto steel_tables = profile->getPerformanceTables(steel);
+    bench.run("braking_events/fused", 1000000, [&](int i) {
+        sink = BrakeCooling::evaluateEvents(steel_tables, i % 100)[0].adjusted_be;
+    });
+    std::vector<BrakeCooling::LandingResult> landing_results(N);
+    bench.run("end_to_end/landing_batch", 50, [&](int) {
+        BrakeCooling::evaluateLandings(steel_tables, inputs.data(), landing_results.data(), N);
+        sink = landing_results[0].reference_be;
+    }, N);
+    Calculation::resultCache().clear();
+    bench.run("end_to_end/cached_landing_repeated", 200000, [&](int i) {
+        sink = Calculation::cachedLanding(*profile, inputs[i % 16], steel).reference_be;
+    });
+
+    QJsonObject document;
+    document.insert("benchmark", "QBrakeCooling");
+    document.insert("format_version", 1);
+    document.insert("timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    document.insert("cpu_architecture", QSysInfo::currentCpuArchitecture());
+    document.insert("qt_version", qVersion());
+    document.insert("results", bench.getResults());
+    const QByteArray json = QJsonDocument(document).toJson();
+
+    QFile output;
+    bool output_ok;
+    if (parser.isSet(output_option)) {
+        output.setFileName(parser.value(output_option));
+        output_ok = output.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    } else {
+        output_ok = output.open(stdout, QIODevice::WriteOnly);
+    }
+    if (!output_ok || output.write(json) != json.size()) {
+        qCritical().noquote() << "Unable to write the results:" << output.errorString();
+        return 1;
+    }
+    return 0;
+}
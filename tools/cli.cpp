@@ -0,0 +1,424 @@
+/*
+ * QBrakeCoolingCli - computes brake cooling times for a file of landings without a user interface
+ *
+ * Input is a CSV file with the columns
+ *     model,speed,weight,temp,alt,taxi,brakes
+ * (an optional header line starting with "model" is skipped) or an NDJSON file with one flat object
+ * per line using the same keys. Weight is given in kg, altitude in ft, the brake category as C/N,
+ * Steel/Carbon or 0/1. The file is memory mapped and parsed in place.
+ *
+ * For every landing, one line holding the reference brake energy and the ten braking event
+ * results is written, idle reverse first. A result is the cooling time in minutes, or one of
+ * NONE (no special procedure), CAUTION, WARNING or ERROR. Landings outside of the performance
+ * tables are reported as ERROR. Every landing is calculated from its exact inputs, nothing is
+ * rounded or cached.
+ *
+ * Compiled tables (see QBrakeCoolingCompile) next to the database are used if present.
+ *
+ * With --storage, the reference grids are held as float32 or fixed point values. The largest cooling
+ * time error against the double grid is reported per model, which keeps the double grid if the error
+ * exceeds --max-storage-error minutes or a braking event changes its band.
+ */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <cstring>
+#include "database.h"
+#include "calculation.h"
+
+namespace {
+
+enum class Format {Csv, NdJson};
+
+/*!
+ * \brief a view of a piece of the mapped input file
+ */
+struct Field
+{
+    const char *begin = nullptr;
+    const char *end = nullptr;
+
+    Field trimmed() const
+    {
+        Field f = *this;
+        while (f.begin < f.end && (*f.begin == ' ' || *f.begin == '\t' || *f.begin == '"'))
+            f.begin++;
+        while (f.end > f.begin && (f.end[-1] == ' ' || f.end[-1] == '\t' || f.end[-1] == '\r' || f.end[-1] == '"'))
+            f.end--;
+        return f;
+    }
+    QByteArray bytes() const { return QByteArray::fromRawData(begin, static_cast<int>(end - begin)); }
+    bool toDouble(double &value) const
+    {
+        bool ok = false;
+        value = trimmed().bytes().toDouble(&ok);
+        return ok;
+    }
+};
+
+/*!
+ * \brief one landing. The model name points into the mapped input file
+ */
+struct Landing
+{
+    Field model;
+    double speed = 0;
+    double weight = 0;
+    double temp = 0;
+    double alt = 0;
+    double taxi_distance = 0;
+    Global::BrakeCategory brake_category = Global::BrakeCategory::Steel;
+};
+
+/*!
+ * \brief assigns a named value to the landing, returns false if the value is invalid
+ */
+bool setLandingValue(Landing &landing, int column, const Field &value)
+{
+    switch (column) {
+    case 0: landing.model = value.trimmed(); return landing.model.begin != landing.model.end;
+    case 1: return value.toDouble(landing.speed);
+    case 2: return value.toDouble(landing.weight);
+    case 3: return value.toDouble(landing.temp);
+    case 4: return value.toDouble(landing.alt);
+    case 5: return value.toDouble(landing.taxi_distance);
+    case 6: return ModelRegistry::parseBrakeCategory(value.trimmed().bytes(), landing.brake_category);
+    default: return true;
+    }
+}
+
+bool parseCsvLine(const Field &line, Landing &landing)
+{
+    int column = 0;
+    const char *field_begin = line.begin;
+    for (const char *p = line.begin; p <= line.end; p++) {
+        if (p == line.end || *p == ',') {
+            if (!setLandingValue(landing, column, {field_begin, p}))
+                return false;
+            column++;
+            field_begin = p + 1;
+        }
+    }
+    return column >= 7;
+}
+
+int ndJsonColumn(const Field &key)
+{
+    static const QByteArray KEYS[] = {"model", "speed", "weight", "temp", "alt", "taxi", "brakes"};
+    const QByteArray k = key.bytes();
+    for (int i = 0; i < 7; i++)
+        if (k == KEYS[i])
+            return i;
+    return -1;
+}
+
+/*!
+ * \brief parses a flat JSON object of strings and numbers, nested values are not supported
+ */
+bool parseNdJsonLine(const Field &line, Landing &landing)
+{
+    const char *p = line.begin;
+    const char *end = line.end;
+    auto skip_whitespace = [&p, end] { while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++; };
+
+    skip_whitespace();
+    if (p == end || *p++ != '{')
+        return false;
+
+    int found = 0;
+    while (true) {
+        skip_whitespace();
+        if (p < end && *p == ',')
+            p++;
+        skip_whitespace();
+        if (p == end)
+            return false;
+        if (*p == '}')
+            break;
+        if (*p++ != '"')
+            return false;
+        const char *key_begin = p;
+        while (p < end && *p != '"')
+            p++;
+        const Field key{key_begin, p};
+        if (p++ == end)
+            return false;
+        skip_whitespace();
+        if (p == end || *p++ != ':')
+            return false;
+        skip_whitespace();
+
+        Field value{p, p};
+        if (p < end && *p == '"') {
+            value.begin = ++p;
+            while (p < end && *p != '"')
+                p++;
+            value.end = p;
+            if (p++ == end)
+                return false;
+        } else {
+            while (p < end && *p != ',' && *p != '}')
+                p++;
+            value.end = p;
+        }
+
+        const int column = ndJsonColumn(key);
+        if (column < 0)
+            continue;
+        if (!setLandingValue(landing, column, value))
+            return false;
+        found |= 1 << column;
+    }
+    return found == 0x7f;
+}
+
+/*!
+ * \brief collects output in memory and writes it in large blocks
+ */
+class OutputBuffer
+{
+public:
+    explicit OutputBuffer(QFile &file) : m_file(file) { m_buffer.reserve(BLOCK_SIZE + 4096); }
+    ~OutputBuffer() { flush(); }
+
+    OutputBuffer &operator<<(const char *text) { m_buffer.append(text); return checkFlush(); }
+    OutputBuffer &operator<<(char c) { m_buffer.append(c); return checkFlush(); }
+    OutputBuffer &operator<<(const QByteArray &text) { m_buffer.append(text); return checkFlush(); }
+    OutputBuffer &operator<<(double value) { m_buffer.append(QByteArray::number(value, 'f', 1)); return checkFlush(); }
+    OutputBuffer &operator<<(qint64 value) { m_buffer.append(QByteArray::number(value)); return checkFlush(); }
+
+    void flush()
+    {
+        m_file.write(m_buffer);
+        m_buffer.clear();
+    }
+private:
+    static constexpr int BLOCK_SIZE = 1 << 20;
+    OutputBuffer &checkFlush()
+    {
+        if (m_buffer.size() >= BLOCK_SIZE)
+            flush();
+        return *this;
+    }
+    QFile &m_file;
+    QByteArray m_buffer;
+};
+
+const char* EVENT_COLUMNS[] = {
+    "MAX_MAN_IDLE", "AB_MAX_IDLE", "AB_3_IDLE", "AB_2_IDLE", "AB_1_IDLE",
+    "MAX_MAN_REVT", "AB_MAX_REVT", "AB_3_REVT", "AB_2_REVT", "AB_1_REVT",
+};
+
+void writeResult(OutputBuffer &out, const BrakeCooling::EventResult &result, Format format)
+{
+    const char *quote = format == Format::NdJson ? "\"" : "";
+    switch (result.band) {
+    case BrakeCooling::CoolingBand::Cooling:
+        out << result.cooling_time;
+        break;
+    case BrakeCooling::CoolingBand::NoProcedure:
+        out << quote << "NONE" << quote;
+        break;
+    case BrakeCooling::CoolingBand::Caution:
+        out << quote << "CAUTION" << quote;
+        break;
+    case BrakeCooling::CoolingBand::Warning:
+        out << quote << "WARNING" << quote;
+        break;
+    }
+}
+
+void writeRow(OutputBuffer &out, qint64 row, double ref_be, const BrakeCooling::EventResults &results, Format format)
+{
+    if (format == Format::Csv) {
+        out << row << ',' << ref_be;
+        for (const auto &result : results) {
+            out << ',';
+            writeResult(out, result, format);
+        }
+        out << '\n';
+    } else {
+        out << "{\"row\":" << row << ",\"refBE\":" << ref_be;
+        for (std::size_t i = 0; i < results.size(); i++) {
+            out << ",\"" << EVENT_COLUMNS[i] << "\":";
+            writeResult(out, results[i], format);
+        }
+        out << "}\n";
+    }
+}
+
+void writeError(OutputBuffer &out, qint64 row, Format format)
+{
+    if (format == Format::Csv)
+        out << row << ",ERROR\n";
+    else
+        out << "{\"row\":" << row << ",\"error\":\"ERROR\"}\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("QBrakeCoolingCli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Computes brake cooling times for a CSV or NDJSON file of landings.");
+    parser.addHelpOption();
+    const QCommandLineOption database_option(QStringList{"d", "database"}, "Database file.", "file", "database.db");
+    const QCommandLineOption format_option(QStringList{"f", "format"}, "Input and output format, csv or ndjson. "
+                                           "Defaults to ndjson for .ndjson and .jsonl files, csv otherwise.", "format");
+    const QCommandLineOption trace_option(QStringList{"t", "trace"}, "Write a Chrome trace of the calculation "
+                                          "stages to file and print a timing summary.", "file");
+    const QCommandLineOption storage_option(QStringList{"s", "storage"}, "Store the reference grids as double, float32, "
+                                            "fixed16 or fixed32. Compact storage is used per model if its cooling "
+                                            "times stay within the maximum storage error.", "format", "double");
+    const QCommandLineOption storage_error_option("max-storage-error", "Maximum cooling time error in minutes "
+                                                  "accepted for compact storage.", "minutes", "0.1");
+    parser.addOption(database_option);
+    parser.addOption(format_option);
+    parser.addOption(trace_option);
+    parser.addOption(storage_option);
+    parser.addOption(storage_error_option);
+    parser.addPositionalArgument("input", "File of landings.");
+    parser.addPositionalArgument("output", "Output file, standard output if omitted.", "[output]");
+    parser.process(app);
+
+    const QStringList arguments = parser.positionalArguments();
+    if (arguments.isEmpty())
+        parser.showHelp(1);
+
+    QFile input(arguments.at(0));
+    if (!input.open(QIODevice::ReadOnly)) {
+        qCritical().noquote() << "Unable to open" << input.fileName() << ':' << input.errorString();
+        return 1;
+    }
+
+    Format format = Format::Csv;
+    const QString suffix = QFileInfo(input.fileName()).suffix().toLower();
+    if (parser.isSet(format_option))
+        format = parser.value(format_option).toLower() == QLatin1String("ndjson") ? Format::NdJson : Format::Csv;
+    else if (suffix == QLatin1String("ndjson") || suffix == QLatin1String("jsonl"))
+        format = Format::NdJson;
+
+    QFile output;
+    bool output_ok;
+    if (arguments.size() > 1) {
+        output.setFileName(arguments.at(1));
+        output_ok = output.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    } else {
+        output_ok = output.open(stdout, QIODevice::WriteOnly);
+    }
+    if (!output_ok) {
+        qCritical().noquote() << "Unable to open output:" << output.errorString();
+        return 1;
+    }
+
+    BrakeCooling::GridStorage storage;
+    if (!ModelRegistry::parseStorage(parser.value(storage_option), storage)) {
+        qCritical().noquote() << "Unknown storage" << parser.value(storage_option);
+        return 1;
+    }
+    ModelRegistry::setStorage(storage, parser.value(storage_error_option).toDouble());
+
+    BrakeCooling::Trace::setEnabled(parser.isSet(trace_option));
+    if (!Database::connect(nullptr, parser.value(database_option)))
+        return 1;
+
+    const qint64 size = input.size();
+    const char *data = size > 0 ? reinterpret_cast<const char*>(input.map(0, size)) : nullptr;
+    if (size > 0 && data == nullptr) {
+        qCritical().noquote() << "Unable to map" << input.fileName() << ':' << input.errorString();
+        return 1;
+    }
+
+    OutputBuffer out(output);
+    if (format == Format::Csv) {
+        out << "row,refBE";
+        for (const char *column : EVENT_COLUMNS)
+            out << ',' << column;
+        out << '\n';
+    }
+
+    // profiles by the model name as written in the input, so names are only converted once
+    QHash<QByteArray, std::shared_ptr<const ModelProfile>> models;
+    const ModelProfile *last_model = nullptr;
+    QByteArray last_model_name;
+
+    qint64 row = 0;
+    qint64 errors = 0;
+    const char *end = data + size;
+    for (const char *line_begin = data; line_begin < end; ) {
+        const char *line_end = static_cast<const char*>(std::memchr(line_begin, '\n', end - line_begin));
+        if (line_end == nullptr)
+            line_end = end;
+        Field line{line_begin, line_end};
+        line_begin = line_end + 1;
+        if (line.end > line.begin && line.end[-1] == '\r')
+            line.end--;
+
+        if (line.trimmed().begin == line.trimmed().end)
+            continue;
+        if (format == Format::Csv && row == 0 && line.trimmed().bytes().startsWith("model"))
+            continue;
+        row++;
+
+        Landing landing;
+        const bool parsed = format == Format::Csv ? parseCsvLine(line, landing) : parseNdJsonLine(line, landing);
+        if (!parsed) {
+            errors++;
+            writeError(out, row, format);
+            continue;
+        }
+
+        const QByteArray model_name = landing.model.bytes();
+        if (last_model == nullptr || model_name != last_model_name) {
+            auto it = models.find(model_name);
+            if (it == models.end()) {
+                // unknown models are kept as nullptr, so they are looked up and reported once
+                auto profile = ModelRegistry::getProfile(QString::fromLatin1(model_name));
+                if (!profile)
+                    qWarning().noquote() << "Unknown model" << QString::fromLatin1(model_name);
+                else if (!profile->isValid())
+                    qWarning().noquote() << "No usable tables for model" << profile->getName();
+                it = models.insert(QByteArray(model_name.constData(), model_name.size()), profile);
+            }
+            last_model = it.value().get();
+            last_model_name = it.key();
+        }
+        if (!last_model || !last_model->hasCompleteTables(landing.brake_category)) {
+            errors++;
+            writeError(out, row, format);
+            continue;
+        }
+
+        BrakeCooling::LandingInputs inputs;
+        inputs.speed         = landing.speed;
+        inputs.weight        = landing.weight;
+        inputs.temp          = landing.temp;
+        inputs.alt           = landing.alt;
+        inputs.taxi_distance = landing.taxi_distance;
+        const auto result = Calculation::landing(*last_model, inputs, landing.brake_category);
+        if (!result.in_envelope) {
+            errors++;
+            writeError(out, row, format);
+            continue;
+        }
+        writeRow(out, row, result.reference_be, result.events, format);
+    }
+    out.flush();
+
+    if (parser.isSet(trace_option)) {
+        QFile trace(parser.value(trace_option));
+        if (trace.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            trace.write(QByteArray::fromStdString(BrakeCooling::Trace::chromeTraceJson()));
+        else
+            qWarning().noquote() << "Unable to write" << trace.fileName() << ':' << trace.errorString();
+        qInfo().noquote() << '\n' + QString::fromStdString(BrakeCooling::Trace::summary());
+    }
+    if (errors > 0)
+        qWarning().noquote() << errors << "of" << row << "landings could not be calculated.";
+    return errors > 0 ? 2 : 0;
+}
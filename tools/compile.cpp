@@ -0,0 +1,65 @@
+/*
+ * QBrakeCoolingCompile - compiles the tables of a model into a binary table file
+ *
+ * The file (see BrakeCooling::TableFile) is written next to the database as <model>.bct, where
+ * QBrakeCooling and QBrakeCoolingCli pick it up instead of loading the tables from the database.
+ * A compiled file older than the database is ignored, so the tables have to be compiled again
+ * after the database has been changed.
+ */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include "database.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("QBrakeCoolingCompile");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Compiles the tables of a model into a memory mapped table file.");
+    parser.addHelpOption();
+    const QCommandLineOption database_option(QStringList{"d", "database"}, "Database file.", "file", "database.db");
+    const QCommandLineOption output_option(QStringList{"o", "output"}, "Output file, <model>.bct next to the "
+                                           "database if omitted.", "file");
+    parser.addOption(database_option);
+    parser.addOption(output_option);
+    parser.addPositionalArgument("model", "Model name, e.g. B_737_800WSFP1.");
+    parser.process(app);
+
+    const QStringList arguments = parser.positionalArguments();
+    if (arguments.size() != 1)
+        parser.showHelp(1);
+
+    if (!Database::connect(nullptr, parser.value(database_option)))
+        return 1;
+
+    QString model = arguments.at(0);
+    model.replace(QLatin1Char('-'), QLatin1Char('_'));
+    const QString file_name = parser.isSet(output_option) ? parser.value(output_option) : Database::tableFileName(model);
+
+    QElapsedTimer timer;
+    timer.start();
+    const BrakeCooling::TableData data = Database::getTableData(model);
+    const std::size_t missing = data.missingValues();
+    if (missing > 0) {
+        qCritical().noquote() << "The tables of" << model << "are incomplete," << missing << "values are missing.";
+        return 1;
+    }
+
+    std::string error_msg;
+    if (!BrakeCooling::TableFile::write(QFile::encodeName(file_name).toStdString(), data, &error_msg)) {
+        qCritical().noquote() << "Unable to compile" << model << ':' << QString::fromStdString(error_msg);
+        return 1;
+    }
+
+    // map the result once, so a file that cannot be used is noticed here
+    const auto table_file = BrakeCooling::TableFile::open(QFile::encodeName(file_name).toStdString(), &error_msg);
+    if (!table_file) {
+        qCritical().noquote() << "Unable to verify" << file_name << ':' << QString::fromStdString(error_msg);
+        return 1;
+    }
+    qInfo().noquote() << "Compiled" << model << "into" << file_name << "in" << timer.elapsed() << "ms,"
+                      << data.reference_be.size() << "reference brake energy values.";
+    return 0;
+}
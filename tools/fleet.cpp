@@ -0,0 +1,239 @@
+/*
+ * QBrakeCoolingFleet - simulates a day of operations of a fleet, carrying the brake energy of every
+ * landing into the following sectors
+ *
+ * Input is a CSV file with one landing per line and the columns
+ *     day,tail,model,brakes,speed,weight,temp,alt,taxi,event,rev,ground
+ * (an optional header line starting with "day" is skipped). Lines with the same day and tail form
+ * the schedule of that tail on that day, in the order of the file. Units and brake category as for
+ * QBrakeCoolingCli, the braking event as MAX_MAN, AB_MAX, AB_3, AB_2, AB_1 or 0-4, rev as 0/1 for
+ * idle reverse / second detent and ground as the minutes on the ground after the landing, empty
+ * for the last sector of the day.
+ *
+ * One line per landing is written, holding the residual adjusted brake energy carried in from the
+ * previous sectors, the adjusted brake energy including it, the cooling time in minutes (or NONE,
+ * CAUTION, WARNING) and a flag: SHORT_TURN if the cooling time exceeds the ground time, CAUTION or
+ * WARNING for landings in these bands, OK otherwise. Landings outside of the performance tables
+ * are calculated with the inputs limited to the table values and marked in the last column.
+ *
+ * With --storage, the reference grids are held as float32 or fixed point values. The largest cooling
+ * time error against the double grid is reported per model, which keeps the double grid if the error
+ * exceeds --max-storage-error minutes or a braking event changes its band.
+ */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include "database.h"
+#include "calculation.h"
+#include "libBrakeCooling/include/fleetSimulation.h"
+
+namespace {
+
+constexpr int COLUMN_COUNT = 12;
+
+bool parseBrakingEvent(const QByteArray &value, BrakeCooling::BrakingEvent &event)
+{
+    static const QByteArray NAMES[] = {"MAX_MAN", "AB_MAX", "AB_3", "AB_2", "AB_1"};
+    for (int i = 0; i < 5; i++) {
+        if (value.compare(NAMES[i], Qt::CaseInsensitive) == 0 || value == QByteArray::number(i)) {
+            event = BrakeCooling::BrakingEvent(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+/*!
+ * \brief the flight of one tail on one day, as given in the input
+ */
+struct Schedule
+{
+    QByteArray day;
+    QByteArray tail;
+    QByteArray model;
+};
+
+const char *coolingText(const BrakeCooling::EventResult &result)
+{
+    switch (result.band) {
+    case BrakeCooling::CoolingBand::NoProcedure: return "NONE";
+    case BrakeCooling::CoolingBand::Caution:     return "CAUTION";
+    case BrakeCooling::CoolingBand::Warning:     return "WARNING";
+    case BrakeCooling::CoolingBand::Cooling:     break;
+    }
+    return nullptr;
+}
+
+const char *flagText(const BrakeCooling::TurnResult &turn)
+{
+    if (!turn.flagged)
+        return "OK";
+    if (turn.result.band == BrakeCooling::CoolingBand::Cooling)
+        return "SHORT_TURN";
+    return coolingText(turn.result);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("QBrakeCoolingFleet");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Simulates the brake energy and cooling of a fleet over the sectors of a day.\n"
+                                     "Input columns: day,tail,model,brakes,speed,weight,temp,alt,taxi,event,rev,ground");
+    parser.addHelpOption();
+    const QCommandLineOption database_option(QStringList{"d", "database"}, "Database file.", "file", "database.db");
+    const QCommandLineOption threads_option(QStringList{"j", "threads"}, "Number of threads, all cores if omitted.", "count", "0");
+    const QCommandLineOption storage_option(QStringList{"s", "storage"}, "Store the reference grids as double, float32, "
+                                            "fixed16 or fixed32. Compact storage is used per model if its cooling "
+                                            "times stay within the maximum storage error.", "format", "double");
+    const QCommandLineOption storage_error_option("max-storage-error", "Maximum cooling time error in minutes "
+                                                  "accepted for compact storage.", "minutes", "0.1");
+    parser.addOption(database_option);
+    parser.addOption(threads_option);
+    parser.addOption(storage_option);
+    parser.addOption(storage_error_option);
+    parser.addPositionalArgument("input", "CSV file of the scheduled landings.");
+    parser.addPositionalArgument("output", "Output file, standard output if omitted.", "[output]");
+    parser.process(app);
+
+    const QStringList arguments = parser.positionalArguments();
+    if (arguments.isEmpty())
+        parser.showHelp(1);
+
+    QFile input(arguments.at(0));
+    if (!input.open(QIODevice::ReadOnly)) {
+        qCritical().noquote() << "Unable to open" << input.fileName() << ':' << input.errorString();
+        return 1;
+    }
+    QFile output;
+    bool output_ok;
+    if (arguments.size() > 1) {
+        output.setFileName(arguments.at(1));
+        output_ok = output.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    } else {
+        output_ok = output.open(stdout, QIODevice::WriteOnly);
+    }
+    if (!output_ok) {
+        qCritical().noquote() << "Unable to open output:" << output.errorString();
+        return 1;
+    }
+
+    BrakeCooling::GridStorage storage;
+    if (!ModelRegistry::parseStorage(parser.value(storage_option), storage)) {
+        qCritical().noquote() << "Unknown storage" << parser.value(storage_option);
+        return 1;
+    }
+    ModelRegistry::setStorage(storage, parser.value(storage_error_option).toDouble());
+
+    if (!Database::connect(nullptr, parser.value(database_option)))
+        return 1;
+
+    // the profiles are kept alive here, the tables point into them. std::map does not move its values.
+    QHash<QByteArray, std::shared_ptr<const ModelProfile>> profiles;
+    std::map<std::pair<QByteArray, int>, BrakeCooling::PerformanceTables> tables;
+
+    std::vector<BrakeCooling::TailDay> tail_days;
+    std::vector<Schedule> schedules;
+    QHash<QByteArray, std::size_t> schedule_index;
+    int line_number = 0;
+    while (!input.atEnd()) {
+        const QByteArray line = input.readLine().trimmed();
+        line_number++;
+        if (line.isEmpty() || (line_number == 1 && line.startsWith("day")))
+            continue;
+
+        const QList<QByteArray> columns = line.split(',');
+        const auto fail = [&](const char *reason) {
+            qCritical().noquote() << input.fileName() + ':' + QString::number(line_number) + ':' << reason;
+            return 1;
+        };
+        if (columns.size() < COLUMN_COUNT)
+            return fail("expected 12 columns");
+
+        const QByteArray model = columns[2].trimmed();
+        Global::BrakeCategory brake_category;
+        BrakeCooling::Sector sector;
+        bool ok[7];
+        sector.landing.speed         = columns[4].toDouble(&ok[0]);
+        sector.landing.weight        = columns[5].toDouble(&ok[1]);
+        sector.landing.temp          = columns[6].toDouble(&ok[2]);
+        sector.landing.alt           = columns[7].toDouble(&ok[3]);
+        sector.landing.taxi_distance = columns[8].toDouble(&ok[4]);
+        const int rev = columns[10].trimmed().toInt(&ok[5]);
+        sector.rev_t = rev != 0;
+        const QByteArray ground = columns[11].trimmed();
+        ok[6] = true;
+        if (!ground.isEmpty())
+            sector.ground_time = ground.toDouble(&ok[6]);
+        if (!std::all_of(std::begin(ok), std::end(ok), [](bool b) {return b;}))
+            return fail("invalid number");
+        if (!ModelRegistry::parseBrakeCategory(columns[3].trimmed(), brake_category))
+            return fail("invalid brake category");
+        if (!parseBrakingEvent(columns[9].trimmed(), sector.event))
+            return fail("invalid braking event");
+
+        auto profile = profiles.value(model);
+        if (!profile) {
+            profile = ModelRegistry::getProfile(QString::fromLatin1(model));
+            if (!profile)
+                return fail("unknown model");
+            profiles.insert(model, profile);
+        }
+        if (!profile->hasCompleteTables(brake_category))
+            return fail("no usable tables for the model");
+        auto table = tables.find({model, int(brake_category)});
+        if (table == tables.end())
+            table = tables.emplace(std::make_pair(model, int(brake_category)), profile->getPerformanceTables(brake_category)).first;
+
+        const QByteArray key = columns[0].trimmed() + ',' + columns[1].trimmed();
+        auto it = schedule_index.find(key);
+        if (it == schedule_index.end()) {
+            it = schedule_index.insert(key, tail_days.size());
+            tail_days.emplace_back();
+            tail_days.back().tables = &table->second;
+            schedules.push_back({columns[0].trimmed(), columns[1].trimmed(), model});
+        } else if (tail_days[it.value()].tables != &table->second) {
+            return fail("model or brake category changes within the day of a tail");
+        }
+        tail_days[it.value()].sectors.push_back(sector);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const auto results = BrakeCooling::simulateFleet(tail_days, parser.value(threads_option).toUInt());
+    const qint64 elapsed = timer.elapsed();
+
+    QByteArray out = "day,tail,sector,model,residualBE,adjustedBE,cooling,ground,flag,inEnvelope\n";
+    std::size_t turns = 0;
+    std::size_t flagged = 0;
+    for (std::size_t i = 0; i < results.size(); i++) {
+        for (std::size_t j = 0; j < results[i].size(); j++) {
+            const auto &turn = results[i][j];
+            const auto &sector = tail_days[i].sectors[j];
+            const char *cooling = coolingText(turn.result);
+            out += schedules[i].day + ',' + schedules[i].tail + ',' + QByteArray::number(qulonglong(j + 1)) + ','
+                    + schedules[i].model + ',' + QByteArray::number(turn.residual_be, 'f', 1) + ','
+                    + QByteArray::number(turn.result.adjusted_be, 'f', 1) + ','
+                    + (cooling ? QByteArray(cooling) : QByteArray::number(turn.result.cooling_time, 'f', 1)) + ','
+                    + (std::isinf(sector.ground_time) ? QByteArray() : QByteArray::number(sector.ground_time, 'f', 0)) + ','
+                    + flagText(turn) + ',' + (turn.in_envelope ? '1' : '0') + '\n';
+            turns++;
+            flagged += turn.flagged;
+        }
+    }
+    if (output.write(out) != out.size()) {
+        qCritical().noquote() << "Unable to write the results:" << output.errorString();
+        return 1;
+    }
+    qInfo().noquote() << tail_days.size() << "tail days," << turns << "landings," << flagged
+                      << "flagged, simulated in" << elapsed << "ms";
+    return flagged > 0 ? 2 : 0;
+}
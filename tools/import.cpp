@@ -0,0 +1,234 @@
+/*
+ * QBrakeCoolingImport - imports the performance tables of a model from CSV files
+ *
+ * Three files are read, each with a header line naming its columns in any order:
+ *     reference brake energy  speed,weight,temperature,altitude,referenceBE
+ *     adjusted brake energy   refBE,event,revT,adjustedBE
+ *     cooling time            brakeCategory,adjustedBE,coolingTime
+ * in the units of the database (kt, t, °C, 1000 ft, event 0-4 as MAX_MAN to AB_1, revT 0/1, brake
+ * category 0 steel / 1 carbon). The key axes are the distinct values of the key columns, and every
+ * combination of them has to be given exactly once: the model is rejected if a corner of the
+ * reference grid, a braking event or a cooling time is missing or repeated.
+ *
+ * The tables are written in a single transaction together with their lookup indexes, replacing
+ * the tables of a model of the same name, and the model is added to MODELS.
+ */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include "database.h"
+#include "modelprofile.h"
+
+namespace {
+
+using Rows = std::vector<std::vector<double>>;
+
+/*!
+ * \brief reads the named columns of a CSV file, in the order of columns
+ */
+bool readCsv(const QString &file_name, const QList<QByteArray> &columns, Rows &rows, QString *error)
+{
+    QFile file(file_name);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = file_name + ": " + file.errorString();
+        return false;
+    }
+
+    QList<int> positions;
+    const QList<QByteArray> header = file.readLine().trimmed().split(',');
+    for (const QByteArray &column : columns) {
+        int position = -1;
+        for (int i = 0; i < header.size(); i++)
+            if (header.at(i).trimmed().replace('"', "") == column)
+                position = i;
+        if (position < 0) {
+            *error = QString("%1: column %2 missing in the header").arg(file_name, QString::fromLatin1(column));
+            return false;
+        }
+        positions.append(position);
+    }
+
+    int line_number = 1;
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        line_number++;
+        if (line.isEmpty())
+            continue;
+        const QList<QByteArray> fields = line.split(',');
+        std::vector<double> row;
+        row.reserve(positions.size());
+        for (const int position : positions) {
+            bool ok = position < fields.size();
+            row.push_back(ok ? fields.at(position).trimmed().toDouble(&ok) : 0);
+            if (!ok) {
+                *error = QString("%1:%2: invalid number in column %3").arg(file_name).arg(line_number)
+                        .arg(QString::fromLatin1(columns.at(row.size() - 1)));
+                return false;
+            }
+        }
+        rows.push_back(std::move(row));
+    }
+    return true;
+}
+
+/*!
+ * \brief the distinct values of a column, ascending
+ */
+std::vector<double> keys(const Rows &rows, std::size_t column)
+{
+    std::vector<double> values;
+    values.reserve(rows.size());
+    for (const auto &row : rows)
+        values.push_back(row[column]);
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    return values;
+}
+
+/*!
+ * \brief stores value at index, failing on a second value for the same keys
+ */
+bool setOnce(std::vector<double> &table, std::size_t index, double value, const QString &keys, QString *error)
+{
+    if (!std::isnan(table[index])) {
+        *error = "duplicate row for " + keys;
+        return false;
+    }
+    table[index] = value;
+    return true;
+}
+
+bool referenceBrakeEnergies(const Rows &rows, BrakeCooling::TableData &data, QString *error)
+{
+    data.speeds  = keys(rows, 0);
+    data.weights = keys(rows, 1);
+    data.temps   = keys(rows, 2);
+    data.alts    = keys(rows, 3);
+    const BrakeCooling::GridAxis axes[] = {data.speeds, data.weights, data.temps, data.alts};
+    data.reference_be.assign(data.speeds.size() * data.weights.size() * data.temps.size() * data.alts.size(),
+                             std::numeric_limits<double>::quiet_NaN());
+    for (const auto &row : rows) {
+        std::size_t index = 0;
+        for (int i = 3; i >= 0; i--)
+            index = index * axes[i].size() + axes[i].indexOf(row[i]);
+        const QString corner = QString("speed %1, weight %2, temperature %3, altitude %4").arg(row[0]).arg(row[1]).arg(row[2]).arg(row[3]);
+        if (!setOnce(data.reference_be, index, row[4], corner, error))
+            return false;
+    }
+    for (std::size_t index = 0; index < data.reference_be.size(); index++) {
+        if (std::isnan(data.reference_be[index])) {
+            std::size_t position[4];
+            std::size_t rest = index;
+            for (int i = 0; i < 4; i++) {
+                position[i] = rest % axes[i].size();
+                rest /= axes[i].size();
+            }
+            *error = QString("no reference brake energy for speed %1, weight %2, temperature %3, altitude %4")
+                    .arg(axes[0][position[0]]).arg(axes[1][position[1]]).arg(axes[2][position[2]]).arg(axes[3][position[3]]);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool adjustedBrakeEnergies(const Rows &rows, BrakeCooling::TableData &data, QString *error)
+{
+    data.ref_bes = keys(rows, 0);
+    const BrakeCooling::GridAxis axis(data.ref_bes);
+    data.adjusted_be.assign(10 * axis.size(), std::numeric_limits<double>::quiet_NaN());
+    for (const auto &row : rows) {
+        const int event = int(row[1]);
+        const int rev_t = int(row[2]);
+        if (event != row[1] || event < 0 || event > 4 || (rev_t != 0 && rev_t != 1) || rev_t != row[2]) {
+            *error = QString("invalid event %1 or revT %2").arg(row[1]).arg(row[2]);
+            return false;
+        }
+        const auto index = BrakeCooling::eventIndex(BrakeCooling::BrakingEvent(event), rev_t) * axis.size() + axis.indexOf(row[0]);
+        if (!setOnce(data.adjusted_be, index, row[3], QString("refBE %1, event %2, revT %3").arg(row[0]).arg(event).arg(rev_t), error))
+            return false;
+    }
+    for (std::size_t index = 0; index < data.adjusted_be.size(); index++) {
+        if (std::isnan(data.adjusted_be[index])) {
+            const std::size_t event_index = index / axis.size();
+            *error = QString("no adjusted brake energy for refBE %1, event %2, revT %3")
+                    .arg(axis[index % axis.size()]).arg(event_index % 5).arg(event_index / 5);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool coolingTimes(const Rows &rows, BrakeCooling::TableData &data, QString *error)
+{
+    Rows categories[2];
+    for (const auto &row : rows) {
+        if (row[0] != 0 && row[0] != 1) {
+            *error = QString("invalid brake category %1").arg(row[0]);
+            return false;
+        }
+        categories[int(row[0])].push_back(row);
+    }
+    data.adjusted_steel  = keys(categories[0], 1);
+    data.adjusted_carbon = keys(categories[1], 1);
+    data.cooling_time.assign(data.adjusted_steel.size() + data.adjusted_carbon.size(), std::numeric_limits<double>::quiet_NaN());
+    for (int category = 0; category < 2; category++) {
+        const BrakeCooling::GridAxis axis(category == 0 ? data.adjusted_steel : data.adjusted_carbon);
+        const std::size_t offset = category == 0 ? 0 : data.adjusted_steel.size();
+        for (const auto &row : categories[category])
+            if (!setOnce(data.cooling_time, offset + axis.indexOf(row[1]), row[2],
+                         QString("brake category %1, adjustedBE %2").arg(category).arg(row[1]), error))
+                return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("QBrakeCoolingImport");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Imports the performance tables of a model from CSV files.");
+    parser.addHelpOption();
+    const QCommandLineOption database_option(QStringList{"d", "database"}, "Database file.", "file", "database.db");
+    parser.addOption(database_option);
+    parser.addPositionalArgument("model", "Model name as listed in the application, e.g. B-737-800WSFP1.");
+    parser.addPositionalArgument("reference", "CSV file with the columns speed,weight,temperature,altitude,referenceBE.");
+    parser.addPositionalArgument("adjusted", "CSV file with the columns refBE,event,revT,adjustedBE.");
+    parser.addPositionalArgument("cooling", "CSV file with the columns brakeCategory,adjustedBE,coolingTime.");
+    parser.process(app);
+
+    const QStringList arguments = parser.positionalArguments();
+    if (arguments.size() != 4)
+        parser.showHelp(1);
+
+    QElapsedTimer timer;
+    timer.start();
+    QString error;
+    Rows reference_rows, adjusted_rows, cooling_rows;
+    BrakeCooling::TableData data;
+    const bool ok = readCsv(arguments.at(1), {"speed", "weight", "temperature", "altitude", "referenceBE"}, reference_rows, &error)
+            && readCsv(arguments.at(2), {"refBE", "event", "revT", "adjustedBE"}, adjusted_rows, &error)
+            && readCsv(arguments.at(3), {"brakeCategory", "adjustedBE", "coolingTime"}, cooling_rows, &error)
+            && referenceBrakeEnergies(reference_rows, data, &error)
+            && adjustedBrakeEnergies(adjusted_rows, data, &error)
+            && coolingTimes(cooling_rows, data, &error);
+    if (!ok) {
+        qCritical().noquote() << "Model rejected:" << error;
+        return 1;
+    }
+
+    if (!Database::connect(nullptr, parser.value(database_option)))
+        return 1;
+    const QString &model = arguments.at(0);
+    if (!Database::importModel(model, ModelRegistry::tableName(model), data, &error)) {
+        qCritical().noquote() << "Unable to import" << model << ':' << error;
+        return 1;
+    }
+    qInfo().noquote() << "Imported" << model << "in" << timer.elapsed() << "ms," << data.reference_be.size()
+                      << "reference brake energy values.";
+    return 0;
+}
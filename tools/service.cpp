@@ -0,0 +1,280 @@
+/*
+ * QBrakeCoolingService - serves brake cooling calculations to local clients over a Unix domain socket
+ * (a named pipe on Windows)
+ *
+ * All models are loaded when the service starts and stay resident, so clients neither connect to the
+ * database nor load tables. The protocol is line based: a client sends one landing per line as
+ *     model,speed,weight,temp,alt,taxi,brakes
+ * with the units of QBrakeCoolingCli, and receives one line per landing, in the order of its requests:
+ *     refBE,MAX_MAN_IDLE,AB_MAX_IDLE,AB_3_IDLE,AB_2_IDLE,AB_1_IDLE,MAX_MAN_REVT,AB_MAX_REVT,AB_3_REVT,AB_2_REVT,AB_1_REVT
+ * where a result is the cooling time in minutes or NONE, CAUTION or WARNING, or ERROR for a landing
+ * that can not be parsed, has no usable tables or is outside of the performance tables. A client may
+ * send any number of lines without waiting for the answers.
+ *
+ * The requests of all clients that arrive while the event loop is busy are coalesced and calculated
+ * in batches per model and brake category with BrakeCooling::evaluateLandings().
+ *
+ * Changes of the database or of the compiled tables are reloaded in the background (see
+ * ModelRegistry::watch()) and used from the next batch on, a batch is always calculated on one version
+ * of the tables.
+ */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QHash>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QPointer>
+#include <QTimer>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <vector>
+#include "database.h"
+#include "calculation.h"
+
+namespace {
+
+/*!
+ * \brief the tables of a model, kept alive by the profile
+ */
+struct Model
+{
+    std::shared_ptr<const ModelProfile> profile;
+    BrakeCooling::PerformanceTables tables[2];
+    bool complete[2] = {false, false};
+};
+
+/*!
+ * \brief one landing waiting for the next batch. tables is nullptr for requests that failed to parse.
+ */
+struct Request
+{
+    QPointer<QLocalSocket> client;
+    const BrakeCooling::PerformanceTables *tables = nullptr;
+    BrakeCooling::LandingInputs inputs;
+};
+
+void appendResult(QByteArray &out, const BrakeCooling::EventResult &result)
+{
+    switch (result.band) {
+    case BrakeCooling::CoolingBand::Cooling:
+        out.append(QByteArray::number(result.cooling_time, 'f', 1));
+        break;
+    case BrakeCooling::CoolingBand::NoProcedure:
+        out.append("NONE");
+        break;
+    case BrakeCooling::CoolingBand::Caution:
+        out.append("CAUTION");
+        break;
+    case BrakeCooling::CoolingBand::Warning:
+        out.append("WARNING");
+        break;
+    }
+}
+
+class Service
+{
+public:
+    explicit Service(QLocalServer &server) : m_server(server)
+    {
+        QObject::connect(&m_server, &QLocalServer::newConnection, &m_server, [this] {
+            while (QLocalSocket *client = m_server.nextPendingConnection()) {
+                QObject::connect(client, &QLocalSocket::readyRead, client, [this, client] { read(client); });
+                QObject::connect(client, &QLocalSocket::disconnected, client, [this, client] {
+                    m_partial_lines.remove(client);
+                    client->deleteLater();
+                });
+            }
+        });
+        m_batch_timer.setSingleShot(true);
+        m_batch_timer.setInterval(0);
+        QObject::connect(&m_batch_timer, &QTimer::timeout, &m_batch_timer, [this] { calculate(); });
+    }
+
+    /*!
+     * \brief loads every model listed in the database, returns the number of models with usable tables
+     */
+    int loadModels()
+    {
+        int usable = 0;
+        for (const QString &name : ModelRegistry::getModelNames()) {
+            const Model *m = model(name.toLatin1());
+            usable += m && (m->complete[0] || m->complete[1]) ? 1 : 0;
+        }
+        return usable;
+    }
+
+private:
+    /*!
+     * \brief the tables of a model listed in MODELS, nullptr for any other name, which is not kept
+     */
+    const Model *model(const QByteArray &name)
+    {
+        auto it = m_models.find(name);
+        if (it == m_models.end()) {
+            Model model;
+            model.profile = ModelRegistry::getProfile(QString::fromLatin1(name));
+            if (!model.profile)
+                return nullptr;
+            for (int i = 0; i < 2; i++) {
+                model.complete[i] = model.profile->hasCompleteTables(Global::BrakeCategory(i));
+                model.tables[i] = model.profile->getPerformanceTables(Global::BrakeCategory(i));
+            }
+            it = m_models.emplace(name, model).first;
+        }
+        return &it->second;
+    }
+
+    /*!
+     * \brief queues the complete lines received from a client, the calculation runs once the event loop is idle
+     */
+    void read(QLocalSocket *client)
+    {
+        // no queued request points into m_models between two batches
+        if (m_requests.empty() && m_version != ModelRegistry::getVersion()) {
+            m_version = ModelRegistry::getVersion();
+            m_models.clear();
+        }
+        QByteArray &pending = m_partial_lines[client];
+        pending.append(client->readAll());
+        qsizetype line_begin = 0;
+        for (qsizetype line_end; (line_end = pending.indexOf('\n', line_begin)) >= 0; line_begin = line_end + 1) {
+            const QByteArray line = pending.mid(line_begin, line_end - line_begin).trimmed();
+            if (!line.isEmpty())
+                m_requests.push_back(parse(client, line));
+        }
+        pending.remove(0, line_begin);
+        if (pending.size() > MAX_LINE_LENGTH) {
+            qWarning().noquote() << "Dropping a client sending a line longer than" << MAX_LINE_LENGTH << "bytes";
+            client->abort();
+        }
+        if (!m_requests.empty() && !m_batch_timer.isActive())
+            m_batch_timer.start();
+    }
+
+    Request parse(QLocalSocket *client, const QByteArray &line)
+    {
+        Request request;
+        request.client = client;
+        const QList<QByteArray> columns = line.split(',');
+        if (columns.size() < 7)
+            return request;
+        bool ok[5];
+        request.inputs.speed         = columns[1].trimmed().toDouble(&ok[0]);
+        request.inputs.weight        = columns[2].trimmed().toDouble(&ok[1]);
+        request.inputs.temp          = columns[3].trimmed().toDouble(&ok[2]);
+        request.inputs.alt           = columns[4].trimmed().toDouble(&ok[3]);
+        request.inputs.taxi_distance = columns[5].trimmed().toDouble(&ok[4]);
+        Global::BrakeCategory brake_category;
+        if (!std::all_of(std::begin(ok), std::end(ok), [](bool b) {return b;})
+                || !ModelRegistry::parseBrakeCategory(columns[6].trimmed(), brake_category))
+            return request;
+        const Model *m = model(columns[0].trimmed());
+        if (m && m->complete[static_cast<int>(brake_category)])
+            request.tables = &m->tables[static_cast<int>(brake_category)];
+        return request;
+    }
+
+    /*!
+     * \brief calculates all queued requests in one batch per tables and answers every client with one write
+     */
+    void calculate()
+    {
+        const std::size_t count = m_requests.size();
+        std::vector<std::size_t> order(count);
+        for (std::size_t i = 0; i < count; i++)
+            order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) {
+            return std::less<>()(m_requests[a].tables, m_requests[b].tables);
+        });
+
+        m_inputs.resize(count);
+        m_results.resize(count);
+        for (std::size_t begin = 0, end; begin < count; begin = end) {
+            const auto *tables = m_requests[order[begin]].tables;
+            for (end = begin; end < count && m_requests[order[end]].tables == tables; end++)
+                m_inputs[end] = m_requests[order[end]].inputs;
+            if (tables != nullptr)
+                BrakeCooling::evaluateLandings(*tables, m_inputs.data() + begin, m_results.data() + begin, end - begin);
+        }
+
+        // answers in the order of the requests, collected per client
+        std::vector<std::size_t> position(count);
+        for (std::size_t i = 0; i < count; i++)
+            position[order[i]] = i;
+        QHash<QLocalSocket*, QByteArray> answers;
+        for (std::size_t i = 0; i < count; i++) {
+            const Request &request = m_requests[i];
+            if (request.client.isNull())
+                continue;
+            QByteArray &out = answers[request.client.data()];
+            const auto &result = m_results[position[i]];
+            if (request.tables == nullptr || !result.in_envelope) {
+                out.append("ERROR\n");
+                continue;
+            }
+            out.append(QByteArray::number(result.reference_be, 'f', 1));
+            for (const auto &event : result.events) {
+                out.append(',');
+                appendResult(out, event);
+            }
+            out.append('\n');
+        }
+        m_requests.clear();
+
+        for (auto it = answers.begin(); it != answers.end(); ++it)
+            it.key()->write(it.value());
+    }
+
+    static constexpr qsizetype MAX_LINE_LENGTH = 4096;
+
+    QLocalServer &m_server;
+    QTimer m_batch_timer;
+    std::map<QByteArray, Model> m_models; // queued requests point to the tables, std::map does not move its values
+    std::uint64_t m_version = ModelRegistry::getVersion(); // of the tables in m_models
+    QHash<QLocalSocket*, QByteArray> m_partial_lines;
+    std::vector<Request> m_requests;
+    std::vector<BrakeCooling::LandingInputs> m_inputs;
+    std::vector<BrakeCooling::LandingResult> m_results;
+};
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("QBrakeCoolingService");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Serves brake cooling calculations to local clients.\n"
+                                     "Request lines: model,speed,weight,temp,alt,taxi,brakes");
+    parser.addHelpOption();
+    const QCommandLineOption database_option(QStringList{"d", "database"}, "Database file.", "file", "database.db");
+    const QCommandLineOption socket_option(QStringList{"s", "socket"}, "Name or path of the local socket.", "name", "qbrakecooling");
+    const QCommandLineOption reload_option("reload-interval", "Interval in ms of checking the database and compiled "
+                                           "tables for changes, 0 disables reloading.", "ms", "2000");
+    parser.addOption(database_option);
+    parser.addOption(socket_option);
+    parser.addOption(reload_option);
+    parser.process(app);
+
+    if (!Database::connect(nullptr, parser.value(database_option)))
+        return 1;
+
+    QLocalServer server;
+    Service service(server);
+    const int models = service.loadModels();
+
+    // a socket file left behind by a service that did not shut down cleanly would block listen()
+    QLocalServer::removeServer(parser.value(socket_option));
+    server.setSocketOptions(QLocalServer::UserAccessOption);
+    if (!server.listen(parser.value(socket_option))) {
+        qCritical().noquote() << "Unable to listen on" << parser.value(socket_option) << ':' << server.errorString();
+        return 1;
+    }
+    qInfo().noquote() << "Serving" << models << "models on" << server.fullServerName();
+    ModelRegistry::watch(parser.value(reload_option).toInt());
+    const int ret = app.exec();
+    ModelRegistry::watch(0);
+    return ret;
+}
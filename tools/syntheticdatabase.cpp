@@ -0,0 +1,158 @@
+#include "syntheticdatabase.h"
+#include <QFile>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+const char* CONNECTION_NAME = "SyntheticDatabase";
+
+// same layout as database/database.db
+const char* SCHEMA[] = {
+    "CREATE TABLE \"%1_RAW_BE\" (\"weight\" INTEGER, \"temperature\" INTEGER, \"speed\" INTEGER, "
+    "\"altitude\" INTEGER, \"referenceBE\" REAL)",
+    "CREATE TABLE \"%1_ADJ_BE\" (\"refBE\" INTEGER, \"event\" INTEGER, \"revT\" INTEGER, \"adjustedBE\" REAL)",
+    "CREATE TABLE \"%1_COOLING_TIME\" (\"brakeCategory\" INTEGER, \"adjustedBE\" REAL, \"coolingTime\" REAL)",
+    "CREATE TABLE \"MODELS\" (\"row_id\" INTEGER, \"name\" TEXT, PRIMARY KEY(\"row_id\" AUTOINCREMENT))",
+    "CREATE TABLE \"%1_KEYS\" (\"speed\" REAL, \"weight\" REAL, \"temp\" REAL, \"alt\" REAL, "
+    "\"referenceBrakeEnergy\" REAL, \"adjustedBrakeEnergySteel\" REAL, \"adjustedBrakeEnergyCarbon\" REAL)",
+};
+
+std::vector<double> range(double first, double last, double step)
+{
+    std::vector<double> values;
+    for (double value = first; value <= last + step / 2; value += step)
+        values.push_back(value);
+    return values;
+}
+
+// speed in kt, weight in t, temperature in °C, altitude in 1000 ft, energies in MJ
+const std::vector<double> SPEEDS   = range(80, 180, 10);
+const std::vector<double> WEIGHTS  = range(40, 80, 5);
+const std::vector<double> TEMPS    = range(0, 50, 10);
+const std::vector<double> ALTS     = range(0, 10, 2);
+const std::vector<double> REF_BES  = range(0, 100, 10);
+const std::vector<double> ADJ_BES  = {0, 15, 20, 25, 30, 35, 40, 45, 50, 55, 60};
+const double EVENT_FACTORS[] = {1.0, 0.9, 0.75, 0.65, 0.55};
+const double REVERSE_THRUST_FACTOR = 0.9;
+const double CATEGORY_FACTORS[] = {1.0, 0.8};
+
+double referenceBe(double speed, double weight, double temp, double alt)
+{
+    return 2.3e-5 * weight * speed * speed * (1 + 0.004 * temp) * (1 + 0.03 * alt);
+}
+
+double coolingTime(double adjusted_be, int brake_category)
+{
+    if (adjusted_be <= 15)
+        return 0;
+    return (adjusted_be - 10) * 2 * CATEGORY_FACTORS[brake_category];
+}
+
+bool exec(QSqlQuery &query, QString *error)
+{
+    if (query.exec())
+        return true;
+    if (error)
+        *error = query.lastError().text() + ": " + query.lastQuery();
+    return false;
+}
+
+bool fill(QSqlDatabase &db, QString *error)
+{
+    const QString model = SyntheticDatabase::MODEL;
+    QSqlQuery query(db);
+
+    for (const char *statement : SCHEMA)
+        if (!query.prepare(QString(statement).arg(model)) || !exec(query, error))
+            return false;
+
+    query.prepare("INSERT INTO MODELS (name) VALUES (?)");
+    query.addBindValue(QString(model).replace(QLatin1Char('_'), QLatin1Char('-')));
+    if (!exec(query, error))
+        return false;
+
+    query.prepare(QString("INSERT INTO %1_RAW_BE (weight, temperature, speed, altitude, referenceBE) "
+                          "VALUES (?, ?, ?, ?, ?)").arg(model));
+    for (double speed : SPEEDS)
+        for (double weight : WEIGHTS)
+            for (double temp : TEMPS)
+                for (double alt : ALTS) {
+                    query.addBindValue(weight);
+                    query.addBindValue(temp);
+                    query.addBindValue(speed);
+                    query.addBindValue(alt);
+                    query.addBindValue(referenceBe(speed, weight, temp, alt));
+                    if (!exec(query, error))
+                        return false;
+                }
+
+    query.prepare(QString("INSERT INTO %1_ADJ_BE (refBE, event, revT, adjustedBE) VALUES (?, ?, ?, ?)").arg(model));
+    for (double ref_be : REF_BES)
+        for (int event = 0; event < 5; event++)
+            for (int rev_t = 0; rev_t < 2; rev_t++) {
+                query.addBindValue(ref_be);
+                query.addBindValue(event);
+                query.addBindValue(rev_t);
+                query.addBindValue(ref_be * EVENT_FACTORS[event] * (rev_t ? REVERSE_THRUST_FACTOR : 1.0));
+                if (!exec(query, error))
+                    return false;
+            }
+
+    query.prepare(QString("INSERT INTO %1_COOLING_TIME (brakeCategory, adjustedBE, coolingTime) VALUES (?, ?, ?)").arg(model));
+    for (int brake_category = 0; brake_category < 2; brake_category++)
+        for (double adjusted_be : ADJ_BES) {
+            query.addBindValue(brake_category);
+            query.addBindValue(adjusted_be);
+            query.addBindValue(coolingTime(adjusted_be, brake_category));
+            if (!exec(query, error))
+                return false;
+        }
+
+    // the key columns have different lengths, shorter columns are padded with NULL
+    const std::vector<double>* keys[] = {&SPEEDS, &WEIGHTS, &TEMPS, &ALTS, &REF_BES, &ADJ_BES, &ADJ_BES};
+    std::size_t rows = 0;
+    for (const auto *key : keys)
+        rows = std::max(rows, key->size());
+    query.prepare(QString("INSERT INTO %1_KEYS (speed, weight, temp, alt, referenceBrakeEnergy, "
+                          "adjustedBrakeEnergySteel, adjustedBrakeEnergyCarbon) VALUES (?, ?, ?, ?, ?, ?, ?)").arg(model));
+    for (std::size_t row = 0; row < rows; row++) {
+        for (const auto *key : keys)
+            query.addBindValue(row < key->size() ? QVariant(key->at(row)) : QVariant());
+        if (!exec(query, error))
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool SyntheticDatabase::create(const QString &file_name, QString *error)
+{
+    QFile::remove(file_name);
+
+    bool ok;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", CONNECTION_NAME);
+        db.setDatabaseName(file_name);
+        ok = db.open();
+        if (!ok) {
+            if (error)
+                *error = db.lastError().text();
+        } else {
+            db.transaction();
+            ok = fill(db, error);
+            if (ok)
+                ok = db.commit();
+            else
+                db.rollback();
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(CONNECTION_NAME);
+    return ok;
+}
@@ -0,0 +1,23 @@
+#ifndef SYNTHETICDATABASE_H
+#define SYNTHETICDATABASE_H
+
+#include <QString>
+
+/*!
+ * \brief Generates a database with the layout of database/database.db, filled with made up tables
+ * \details The real performance tables are proprietary. The synthetic tables are smooth, monotonic
+ * and cover the input range of the user interface, so that the benchmark and verification tools can
+ * exercise every code path without them. The values have no operational meaning.
+ */
+class SyntheticDatabase
+{
+public:
+    const static inline char* MODEL = "B_737_800WSFP1";
+
+    /*!
+     * \brief creates the database file, replacing an existing file. Returns false and sets error on failure.
+     */
+    static bool create(const QString &file_name, QString *error = nullptr);
+};
+
+#endif // SYNTHETICDATABASE_H
@@ -0,0 +1,384 @@
+/*
+ * verify - differential test of the optimised calculation paths against the SQL reference path
+ *
+ * Landings are generated on the grid nodes, on the borders between cells, just inside and just outside
+ * of the envelope and at random, and calculated the way the application originally did: one SQL lookup
+ * per table value, interpolated with Interpol and MultilinearInterpol. The same landings are then
+ * calculated by every optimised path (in-memory tables, the library kernel, the batch kernel, the
+ * incremental calculation, the result cache and compiled tables) and the largest divergence of the
+ * reference brake energy, the adjusted brake energies and the cooling times is reported per path,
+ * together with the number of braking events whose band changed and of landings whose envelope state
+ * differs.
+ *
+ * Without --database, the synthetic database of bench (see SyntheticDatabase) is generated in a
+ * temporary directory, and its compiled tables are also checked to be used after reopening it. The exit
+ * code is 2 if any path diverges by more than --tolerance.
+ */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QTemporaryDir>
+#include <random>
+#include "database.h"
+#include "calculation.h"
+#include "syntheticdatabase.h"
+
+namespace {
+
+/*!
+ * \brief the original calculation, every table value looked up with its own query
+ */
+class SqlReference
+{
+public:
+    explicit SqlReference(const QString &model)
+        : m_model(model),
+          m_speeds(Database::getTableValues(model, Global::Parameter::Speed)),
+          m_weights(Database::getTableValues(model, Global::Parameter::Weight)),
+          m_temps(Database::getTableValues(model, Global::Parameter::Temperature)),
+          m_alts(Database::getTableValues(model, Global::Parameter::Altitude)),
+          m_ref_be(Database::getTableValues(model, Global::Parameter::RefBe)),
+          m_adjusted{BrakeCooling::GridAxis(Database::getTableValues(model, Global::Parameter::AdjustedSteel)),
+                     BrakeCooling::GridAxis(Database::getTableValues(model, Global::Parameter::AdjustedCarbon))}
+    {
+        for (int i = 0; i < 2; i++) {
+            m_caution_values[i] = Database::getCautionValue(model, Global::BrakeCategory(i));
+            m_warning_values[i] = Database::getWarningValue(model, Global::BrakeCategory(i));
+        }
+    }
+
+    const BrakeCooling::GridAxis &getSpeedAxis()  const {return m_speeds;}
+    const BrakeCooling::GridAxis &getWeightAxis() const {return m_weights;}
+    const BrakeCooling::GridAxis &getTempAxis()   const {return m_temps;}
+    const BrakeCooling::GridAxis &getAltAxis()    const {return m_alts;}
+
+    BrakeCooling::LandingResult landing(const BrakeCooling::LandingInputs &inputs, Global::BrakeCategory brake_category) const
+    {
+        const BrakeCooling::Params speed(inputs.speed, m_speeds);
+        const BrakeCooling::Params weight(inputs.weight / double(1000), m_weights);
+        const BrakeCooling::Params temp(inputs.temp, m_temps);
+        const BrakeCooling::Params alt(inputs.alt / double(1000), m_alts);
+
+        BrakeCooling::LandingResult result;
+        result.in_envelope = !(speed.isOutOfEnvelope() || weight.isOutOfEnvelope()
+                               || temp.isOutOfEnvelope() || alt.isOutOfEnvelope());
+        result.reference_be = BrakeCooling::Interpol(speed, weight, temp, alt,
+                                                     Database::getReferenceBrakingEnergyValues(m_model, speed, weight, temp, alt))
+                .getReferenceBrakingEnergy() + inputs.taxi_distance;
+
+        const BrakeCooling::Params ref_be(result.reference_be, m_ref_be);
+        const int category = static_cast<int>(brake_category);
+        for (int i = 0; i < 2; i++) {
+            const bool rev_t = i;
+            for (int j = 0; j < 5; j++) {
+                auto &event = result.events[BrakeCooling::eventIndex(BrakeCooling::BrakingEvent(j), rev_t)];
+                // the tables end at the last key, see BrakeCooling::adjustedBrakeEnergy()
+                event.adjusted_be = result.reference_be > m_ref_be[m_ref_be.size() - 1]
+                        ? std::numeric_limits<double>::infinity()
+                        : interpolate(ref_be, [&](double key) {
+                    return Database::getAdjustedBe(m_model, static_cast<int>(key), Global::BrakingEvent(j), rev_t);
+                });
+                if (event.adjusted_be > m_warning_values[category]) {
+                    event.band = BrakeCooling::CoolingBand::Warning;
+                } else if (event.adjusted_be > m_caution_values[category]) {
+                    event.band = BrakeCooling::CoolingBand::Caution;
+                } else {
+                    const BrakeCooling::Params adjusted_be(event.adjusted_be, m_adjusted[category]);
+                    event.cooling_time = adjusted_be.getHighBorder() == 0 ? -1 : interpolate(adjusted_be, [&](double key) {
+                        return Database::getCoolingTime(m_model, brake_category, key);
+                    });
+                    event.band = event.cooling_time > 0 ? BrakeCooling::CoolingBand::Cooling
+                                                        : BrakeCooling::CoolingBand::NoProcedure;
+                }
+            }
+        }
+        return result;
+    }
+
+private:
+    template <typename Lookup>
+    static double interpolate(const BrakeCooling::Params &params, Lookup &&lookup)
+    {
+        const double low  = lookup(params.getLowBorder());
+        const double high = params.getInputParameter() == params.getLowBorder() ? low : lookup(params.getHighBorder());
+        return BrakeCooling::MultilinearInterpol<1>::interpolate({ params.getValues() }, { low, high });
+    }
+
+    QString m_model;
+    BrakeCooling::GridAxis m_speeds;
+    BrakeCooling::GridAxis m_weights;
+    BrakeCooling::GridAxis m_temps;
+    BrakeCooling::GridAxis m_alts;
+    BrakeCooling::GridAxis m_ref_be;
+    BrakeCooling::GridAxis m_adjusted[2];
+    double m_caution_values[2] = {};
+    double m_warning_values[2] = {};
+};
+
+/*!
+ * \brief a landing and the brake category it is calculated for
+ */
+struct Case
+{
+    BrakeCooling::LandingInputs inputs;
+    Global::BrakeCategory brake_category = Global::BrakeCategory::Steel;
+};
+
+/*!
+ * \brief the largest differences of one path from the reference
+ */
+class Divergence
+{
+public:
+    explicit Divergence(const QString &name) : m_name(name) {}
+
+    void compare(const Case &c, const BrakeCooling::LandingResult &reference, const BrakeCooling::LandingResult &result)
+    {
+        m_landings++;
+        if (reference.in_envelope != result.in_envelope)
+            m_envelope_changes++;
+        update(m_ref_be, reference.reference_be, result.reference_be, c);
+        for (std::size_t i = 0; i < reference.events.size(); i++) {
+            const auto &expected = reference.events[i];
+            const auto &actual = result.events[i];
+            update(m_adjusted_be, expected.adjusted_be, actual.adjusted_be, c);
+            if (expected.band != actual.band)
+                m_band_changes++;
+            else if (expected.band == BrakeCooling::CoolingBand::Cooling)
+                update(m_cooling_time, expected.cooling_time, actual.cooling_time, c);
+        }
+    }
+
+    bool exceeds(double tolerance) const
+    {
+        return m_ref_be > tolerance || m_adjusted_be > tolerance || m_cooling_time > tolerance
+                || m_band_changes > 0 || m_envelope_changes > 0;
+    }
+
+    void report(double tolerance) const
+    {
+        qInfo().noquote() << QString("%1 %2 %3 %4 %5 %6 %7 %8")
+                             .arg(m_name, -28).arg(m_landings, 9)
+                             .arg(m_ref_be, 12, 'g', 3).arg(m_adjusted_be, 12, 'g', 3).arg(m_cooling_time, 12, 'g', 3)
+                             .arg(m_band_changes, 7).arg(m_envelope_changes, 9)
+                             .arg(QLatin1String(exceeds(tolerance) ? "FAIL" : "ok"));
+        if (exceeds(tolerance))
+            qInfo().noquote() << QString("%1 worst landing: speed %2 weight %3 temp %4 alt %5 taxi %6 brakes %7")
+                                 .arg(QString(), -28)
+                                 .arg(m_worst.inputs.speed, 0, 'g', 17).arg(m_worst.inputs.weight, 0, 'g', 17)
+                                 .arg(m_worst.inputs.temp, 0, 'g', 17).arg(m_worst.inputs.alt, 0, 'g', 17)
+                                 .arg(m_worst.inputs.taxi_distance, 0, 'g', 17).arg(static_cast<int>(m_worst.brake_category));
+    }
+
+    static void header()
+    {
+        qInfo().noquote() << QString("%1 %2 %3 %4 %5 %6 %7")
+                             .arg(QStringLiteral("path"), -28).arg(QStringLiteral("landings"), 9)
+                             .arg(QStringLiteral("refBE"), 12).arg(QStringLiteral("adjustedBE"), 12)
+                             .arg(QStringLiteral("cooling"), 12).arg(QStringLiteral("bands"), 7)
+                             .arg(QStringLiteral("envelope"), 9);
+    }
+
+private:
+    void update(double &maximum, double expected, double actual, const Case &c)
+    {
+        // equal infinities, i.e. both above the reference brake energy axis
+        if (expected == actual || (std::isnan(expected) && std::isnan(actual)))
+            return;
+        const double difference = std::isnan(expected) != std::isnan(actual) ? std::numeric_limits<double>::infinity()
+                                                                              : std::abs(expected - actual);
+        if (difference > maximum) {
+            maximum = difference;
+            m_worst = c;
+        }
+    }
+
+    QString m_name;
+    qint64 m_landings = 0;
+    qint64 m_band_changes = 0;
+    qint64 m_envelope_changes = 0;
+    double m_ref_be = 0;
+    double m_adjusted_be = 0;
+    double m_cooling_time = 0;
+    Case m_worst;
+};
+
+/*!
+ * \brief a value of an axis for the given kind of landing
+ */
+double axisValue(const BrakeCooling::GridAxis &axis, int kind, std::mt19937_64 &generator)
+{
+    const double first = axis[0];
+    const double last  = axis[axis.size() - 1];
+    const auto key = [&] { return axis[std::uniform_int_distribution<std::size_t>(0, axis.size() - 1)(generator)]; };
+    const auto coin = [&] { return std::uniform_int_distribution<int>(0, 1)(generator) == 1; };
+    switch (kind) {
+    case 0: // grid node
+        return key();
+    case 1: // cell border, on a key in about every second dimension
+        return coin() ? key() : std::uniform_real_distribution<double>(first, last)(generator);
+    case 2: // just inside of the envelope
+        return coin() ? std::nextafter(first, last) : std::nextafter(last, first);
+    case 3: // just outside of the envelope in some dimensions
+        if (coin())
+            return std::uniform_real_distribution<double>(first, last)(generator);
+        return coin() ? std::nextafter(first, -std::numeric_limits<double>::infinity())
+                      : std::nextafter(last, std::numeric_limits<double>::infinity());
+    default:
+        return std::uniform_real_distribution<double>(first, last)(generator);
+    }
+}
+
+std::vector<Case> generateCases(const SqlReference &reference, int count, std::uint64_t seed)
+{
+    std::mt19937_64 generator(seed);
+    std::vector<Case> cases(std::max(count, 0));
+    for (int i = 0; i < count; i++) {
+        auto &c = cases[i];
+        const int kind = i % 5;
+        c.inputs.speed  = axisValue(reference.getSpeedAxis(), kind, generator);
+        c.inputs.weight = axisValue(reference.getWeightAxis(), kind, generator) * 1000;
+        c.inputs.temp   = axisValue(reference.getTempAxis(), kind, generator);
+        c.inputs.alt    = axisValue(reference.getAltAxis(), kind, generator) * 1000;
+        c.inputs.taxi_distance = i % 2 ? std::uniform_real_distribution<double>(0, 3)(generator) : 0;
+        c.brake_category = Global::BrakeCategory(std::uniform_int_distribution<int>(0, 1)(generator));
+    }
+    return cases;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("verify");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Compares the optimised calculation paths with the SQL reference path.");
+    parser.addHelpOption();
+    const QCommandLineOption database_option(QStringList{"d", "database"}, "Verify the tables of this database "
+                                             "instead of a synthetic one.", "file");
+    const QCommandLineOption model_option(QStringList{"m", "model"}, "Model to verify, the synthetic model if omitted.", "model");
+    const QCommandLineOption count_option(QStringList{"n", "landings"}, "Number of landings.", "count", "10000");
+    const QCommandLineOption seed_option("seed", "Seed of the generated landings.", "seed", "1");
+    const QCommandLineOption tolerance_option("tolerance", "Largest accepted absolute divergence.", "value", "1e-9");
+    parser.addOption(database_option);
+    parser.addOption(model_option);
+    parser.addOption(count_option);
+    parser.addOption(seed_option);
+    parser.addOption(tolerance_option);
+    parser.process(app);
+
+    QTemporaryDir dir;
+    const bool synthetic = !parser.isSet(database_option);
+    QString db_file = parser.value(database_option);
+    if (synthetic) {
+        db_file = dir.filePath("synthetic.db");
+        QString error;
+        if (!dir.isValid() || !SyntheticDatabase::create(db_file, &error)) {
+            qCritical().noquote() << "Unable to create the synthetic database:" << error;
+            return 1;
+        }
+    }
+    if (!Database::connect(nullptr, db_file))
+        return 1;
+
+    const QString model = ModelRegistry::tableName(parser.isSet(model_option) ? parser.value(model_option)
+                                                                              : QString(SyntheticDatabase::MODEL));
+    const auto profile = ModelRegistry::getProfile(model);
+    if (!profile) {
+        qCritical().noquote() << "The model" << model << "is not listed in the database.";
+        return 1;
+    }
+    if (!profile->hasCompleteTables(Global::BrakeCategory::Steel) || !profile->hasCompleteTables(Global::BrakeCategory::Carbon)) {
+        qCritical().noquote() << "The tables of" << model << "are incomplete.";
+        return 1;
+    }
+    const double tolerance = parser.value(tolerance_option).toDouble();
+
+    const SqlReference reference(model);
+    const auto cases = generateCases(reference, parser.value(count_option).toInt(), parser.value(seed_option).toULongLong());
+    std::vector<BrakeCooling::LandingResult> expected;
+    expected.reserve(cases.size());
+    for (const auto &c : cases)
+        expected.push_back(reference.landing(c.inputs, c.brake_category));
+
+    std::vector<Divergence> paths;
+
+    paths.emplace_back(profile->getTableFile() ? "compiled tables" : "in-memory tables");
+    for (std::size_t i = 0; i < cases.size(); i++)
+        paths.back().compare(cases[i], expected[i], Calculation::landing(*profile, cases[i].inputs, cases[i].brake_category));
+
+    const BrakeCooling::PerformanceTables tables[2] = {profile->getPerformanceTables(Global::BrakeCategory::Steel),
+                                                       profile->getPerformanceTables(Global::BrakeCategory::Carbon)};
+    paths.emplace_back("evaluateLanding");
+    for (std::size_t i = 0; i < cases.size(); i++)
+        paths.back().compare(cases[i], expected[i],
+                             BrakeCooling::evaluateLanding(tables[static_cast<int>(cases[i].brake_category)], cases[i].inputs));
+
+    // every landing in one batch per brake category
+    std::vector<BrakeCooling::LandingInputs> inputs;
+    for (const auto &c : cases)
+        inputs.push_back(c.inputs);
+    std::vector<BrakeCooling::LandingResult> batch[2];
+    for (int i = 0; i < 2; i++) {
+        batch[i].resize(inputs.size());
+        BrakeCooling::evaluateLandings(tables[i], inputs.data(), batch[i].data(), inputs.size());
+    }
+    paths.emplace_back("evaluateLandings");
+    for (std::size_t i = 0; i < cases.size(); i++)
+        paths.back().compare(cases[i], expected[i], batch[static_cast<int>(cases[i].brake_category)][i]);
+
+    IncrementalCalculation incremental;
+    paths.emplace_back("incremental");
+    for (std::size_t i = 0; i < cases.size(); i++)
+        paths.back().compare(cases[i], expected[i], incremental.calculate(profile, cases[i].inputs, cases[i].brake_category));
+
+    // the cache answers with the result of the quantized inputs, once computed and once cached
+    Calculation::resultCache().clear();
+    paths.emplace_back("result cache");
+    for (int pass = 0; pass < 2; pass++) {
+        for (const auto &c : cases) {
+            const auto quantized = Calculation::resultCache().quantize(c.inputs);
+            paths.back().compare(c, reference.landing(quantized, c.brake_category),
+                                 Calculation::cachedLanding(*profile, c.inputs, c.brake_category));
+        }
+    }
+
+    if (synthetic) {
+        const QString table_file = Database::tableFileName(model);
+        std::string error;
+        if (!BrakeCooling::TableFile::write(QFile::encodeName(table_file).toStdString(), Database::getTableData(model), &error)) {
+            qCritical().noquote() << "Unable to compile" << model << ':' << QString::fromStdString(error);
+            return 1;
+        }
+        const ModelProfile compiled(model);
+        if (!compiled.getTableFile()) {
+            qCritical().noquote() << "Unable to map" << table_file;
+            return 1;
+        }
+        paths.emplace_back("compiled tables");
+        for (std::size_t i = 0; i < cases.size(); i++)
+            paths.back().compare(cases[i], expected[i], Calculation::landing(compiled, cases[i].inputs, cases[i].brake_category));
+
+        // like a restart: SQLite removes the write-ahead log with the last connection and the next
+        // connection creates it again, which must not make the compiled tables look stale
+        Database::disconnect();
+        if (!Database::connect(nullptr, db_file))
+            return 1;
+        if (!ModelProfile(model).getTableFile()) {
+            qCritical().noquote() << table_file << "is not used after reopening the database";
+            return 1;
+        }
+    }
+
+    qInfo().noquote() << "Largest absolute divergence from the SQL reference path for" << model
+                      << "(tolerance" << tolerance << "):";
+    Divergence::header();
+    bool failed = false;
+    for (const auto &path : paths) {
+        path.report(tolerance);
+        failed = failed || path.exceeds(tolerance);
+    }
+    return failed ? 2 : 0;
+}
@@ -0,0 +1,140 @@
+#include "uncertaintydialog.h"
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QHeaderView>
+#include <QVBoxLayout>
+#include <QtConcurrent>
+
+namespace {
+
+QDoubleSpinBox *spreadSpinBox(double maximum, double value, int decimals, const QString &suffix, QWidget *parent)
+{
+    auto *spin_box = new QDoubleSpinBox(parent);
+    spin_box->setRange(0, maximum);
+    spin_box->setDecimals(decimals);
+    spin_box->setValue(value);
+    spin_box->setSuffix(suffix);
+    return spin_box;
+}
+
+} // namespace
+
+UncertaintyDialog::UncertaintyDialog(std::shared_ptr<const ModelProfile> profile,
+                                     const BrakeCooling::LandingInputs &inputs,
+                                     Global::BrakeCategory brake_category,
+                                     QWidget *parent)
+    : QDialog(parent)
+    , m_profile(std::move(profile))
+    , m_inputs(inputs)
+    , m_brake_category(brake_category)
+{
+    setWindowTitle(tr("Cooling Time Uncertainty"));
+
+    m_distribution_combo_box = new QComboBox(this);
+    m_distribution_combo_box->addItem(tr("Normal (standard deviation)"), int(BrakeCooling::DistributionType::Normal));
+    m_distribution_combo_box->addItem(tr("Uniform (± half width)"), int(BrakeCooling::DistributionType::Uniform));
+
+    m_speed_spin_box         = spreadSpinBox(50, 5, 1, tr(" kt"), this);
+    m_weight_spin_box        = spreadSpinBox(20000, 1000, 0, tr(" kg"), this);
+    m_temp_spin_box          = spreadSpinBox(30, 3, 1, tr(" °C"), this);
+    m_alt_spin_box           = spreadSpinBox(5000, 0, 0, tr(" ft"), this);
+    m_taxi_distance_spin_box = spreadSpinBox(10, 0.5, 1, tr(" miles"), this);
+
+    m_samples_spin_box = new QSpinBox(this);
+    m_samples_spin_box->setRange(1000, 2000000);
+    m_samples_spin_box->setSingleStep(50000);
+    m_samples_spin_box->setValue(200000);
+
+    auto *form = new QFormLayout;
+    form->addRow(tr("Distribution"), m_distribution_combo_box);
+    form->addRow(tr("Speed"), m_speed_spin_box);
+    form->addRow(tr("Weight"), m_weight_spin_box);
+    form->addRow(tr("Temperature"), m_temp_spin_box);
+    form->addRow(tr("Altitude"), m_alt_spin_box);
+    form->addRow(tr("Taxi Distance"), m_taxi_distance_spin_box);
+    form->addRow(tr("Samples"), m_samples_spin_box);
+
+    m_results_table = new QTableWidget(10, 5, this);
+    m_results_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_results_table->setHorizontalHeaderLabels({tr("P50"), tr("P90"), tr("P99"), tr("Caution"), tr("Warning")});
+    QStringList events;
+    for (const bool rev_t : {false, true})
+        for (const auto &name : Global::BRAKING_EVENT_DISPLAY_NAMES)
+            events.append(QString(name) + " - " + Global::REVERSE_THRUST_DISPLAY_NAMES.value(rev_t));
+    m_results_table->setVerticalHeaderLabels(events);
+    m_results_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+
+    m_status_label = new QLabel(tr("Means as entered in the main window. Cooling times in minutes, "
+                                   "\"-\" means no special procedure, \"band\" that the caution or warning "
+                                   "band is entered at that percentile."), this);
+    m_status_label->setWordWrap(true);
+
+    m_run_button = new QPushButton(tr("Run"), this);
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    buttons->addButton(m_run_button, QDialogButtonBox::ActionRole);
+    QObject::connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    QObject::connect(m_run_button, &QPushButton::clicked, this, &UncertaintyDialog::run);
+    QObject::connect(&m_watcher, &QFutureWatcherBase::finished, this, &UncertaintyDialog::showResult);
+
+    auto *layout = new QVBoxLayout(this);
+    layout->addLayout(form);
+    layout->addWidget(m_results_table);
+    layout->addWidget(m_status_label);
+    layout->addWidget(buttons);
+}
+
+void UncertaintyDialog::run()
+{
+    const auto type = BrakeCooling::DistributionType(m_distribution_combo_box->currentData().toInt());
+    BrakeCooling::UncertainInputs inputs;
+    inputs.speed         = {type, m_inputs.speed, m_speed_spin_box->value()};
+    inputs.weight        = {type, m_inputs.weight, m_weight_spin_box->value()};
+    inputs.temp          = {type, m_inputs.temp, m_temp_spin_box->value()};
+    inputs.alt           = {type, m_inputs.alt, m_alt_spin_box->value()};
+    inputs.taxi_distance = {type, m_inputs.taxi_distance, m_taxi_distance_spin_box->value()};
+    BrakeCooling::MonteCarloSettings settings;
+    settings.samples = m_samples_spin_box->value();
+
+    m_run_button->setEnabled(false);
+    m_status_label->setText(tr("Running %1 samples...").arg(settings.samples));
+    // the worker holds its own reference to the profile, so closing the dialog early is safe
+    const auto profile = m_profile;
+    const auto brake_category = m_brake_category;
+    m_watcher.setFuture(QtConcurrent::run([profile, inputs, settings, brake_category]() {
+        return Calculation::monteCarlo(*profile, inputs, settings, brake_category);
+    }));
+}
+
+void UncertaintyDialog::showResult()
+{
+    m_run_button->setEnabled(true);
+    const auto result = m_watcher.result();
+    if (result.samples == 0) {
+        m_status_label->setText(tr("The performance tables of this model are incomplete."));
+        return;
+    }
+
+    const auto minutes = [this](const double &value) {
+        if (std::isinf(value))
+            return tr("band");
+        return value > 0 ? QString::number(value, 'f', 0) : QStringLiteral("-");
+    };
+    const auto percent = [](const double &probability) {
+        return QStringLiteral("%1 %").arg(probability * 100, 0, 'f', 1);
+    };
+    for (int row = 0; row < int(result.events.size()); row++) {
+        const auto &event = result.events[row];
+        const QStringList texts = {minutes(event.p50), minutes(event.p90), minutes(event.p99),
+                                   percent(event.caution_probability), percent(event.warning_probability)};
+        for (int column = 0; column < texts.size(); column++) {
+            auto *item = new QTableWidgetItem(texts[column]);
+            item->setTextAlignment(Qt::AlignCenter);
+            m_results_table->setItem(row, column, item);
+        }
+    }
+    QString status = tr("%1 samples.").arg(result.samples);
+    if (result.out_of_envelope_probability > 0)
+        status += ' ' + tr("%1 outside of the performance tables, limited to the table values.")
+                .arg(percent(result.out_of_envelope_probability));
+    m_status_label->setText(status);
+}
@@ -0,0 +1,51 @@
+#ifndef UNCERTAINTYDIALOG_H
+#define UNCERTAINTYDIALOG_H
+
+#include <QDialog>
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QFutureWatcher>
+#include <QLabel>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTableWidget>
+#include "calculation.h"
+
+/*!
+ * \brief Shows the spread of the cooling times when the landing inputs are uncertain
+ * \details The inputs entered in the main window are taken as the means, the spreads are entered
+ * in the dialog. The samples are run on a worker thread, which uses all cores itself.
+ */
+class UncertaintyDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    UncertaintyDialog(std::shared_ptr<const ModelProfile> profile,
+                      const BrakeCooling::LandingInputs &inputs,
+                      Global::BrakeCategory brake_category,
+                      QWidget *parent = nullptr);
+
+private slots:
+    void run();
+    void showResult();
+
+private:
+    std::shared_ptr<const ModelProfile> m_profile;
+    BrakeCooling::LandingInputs m_inputs;
+    Global::BrakeCategory m_brake_category;
+
+    QComboBox *m_distribution_combo_box;
+    QDoubleSpinBox *m_speed_spin_box;
+    QDoubleSpinBox *m_weight_spin_box;
+    QDoubleSpinBox *m_temp_spin_box;
+    QDoubleSpinBox *m_alt_spin_box;
+    QDoubleSpinBox *m_taxi_distance_spin_box;
+    QSpinBox *m_samples_spin_box;
+    QPushButton *m_run_button;
+    QTableWidget *m_results_table;
+    QLabel *m_status_label;
+
+    QFutureWatcher<BrakeCooling::MonteCarloResult> m_watcher;
+};
+
+#endif // UNCERTAINTYDIALOG_H